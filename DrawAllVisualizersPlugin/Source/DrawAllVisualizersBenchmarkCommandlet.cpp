@@ -0,0 +1,441 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DrawAllVisualizersBenchmarkCommandlet.h"
+#include "DrawAllVisualizersEditorSubsystem.h"
+#include "CanvasTypes.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Editor.h"
+#include "EngineUtils.h"
+#include "Logging/StructuredLog.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "SceneManagement.h"
+#include "SceneView.h"
+#include "Selection.h"
+#include "Components/SplineComponent.h"
+
+namespace DrawAllVisualizers
+{
+// Counts what visualizers draw, nothing is rendered.
+class FCountingPDI : public FPrimitiveDrawInterface
+{
+public:
+	explicit FCountingPDI(const FSceneView* InView) : FPrimitiveDrawInterface(InView) {}
+
+	virtual bool IsHitTesting() override { return false; }
+	virtual void SetHitProxy(HHitProxy* HitProxy) override {}
+	virtual void RegisterDynamicResource(FDynamicPrimitiveResource* DynamicResource) override {}
+	virtual void AddReserveLines(uint8 DepthPriorityGroup, int32 NumLines, bool bDepthBiased = false, bool bThickLines = false) override {}
+	virtual void DrawSprite(const FVector& Position, float SizeX, float SizeY, const FTexture* Sprite, const FLinearColor& Color, uint8 DepthPriorityGroup,
+	                        float U, float UL, float V, float VL, uint8 BlendMode = 1, float OpacityMaskRefVal = .5f) override { ++NumSprites; }
+	virtual void DrawLine(const FVector& Start, const FVector& End, const FLinearColor& Color, uint8 DepthPriorityGroup,
+	                      float Thickness = 0.0f, float DepthBias = 0.0f, bool bScreenSpace = false) override { ++NumLines; }
+	virtual void DrawTranslucentLine(const FVector& Start, const FVector& End, const FLinearColor& Color, uint8 DepthPriorityGroup,
+	                                 float Thickness = 0.0f, float DepthBias = 0.0f, bool bScreenSpace = false) override { ++NumLines; }
+	virtual void DrawPoint(const FVector& Position, const FLinearColor& Color, float PointSize, uint8 DepthPriorityGroup) override { ++NumPoints; }
+	virtual int32 DrawMesh(const FMeshBatch& Mesh) override { ++NumMeshes; return 1; }
+
+	void Reset() { NumLines = NumPoints = NumSprites = NumMeshes = 0; }
+
+	int64 NumLines = 0;
+	int64 NumPoints = 0;
+	int64 NumSprites = 0;
+	int64 NumMeshes = 0;
+};
+
+// Canvas needs a render target for its size. Nothing is flushed to it.
+class FBenchmarkRenderTarget : public FRenderTarget
+{
+public:
+	virtual FIntPoint GetSizeXY() const override { return FIntPoint(1920, 1080); }
+};
+
+struct FBenchmarkTimings
+{
+	TArray<double> Milliseconds;
+
+	void Add(double Seconds) { Milliseconds.Add(Seconds * 1000.0); }
+
+	double Median()
+	{
+		if (Milliseconds.Num() == 0) return 0.0;
+		Milliseconds.Sort();
+		return Milliseconds[Milliseconds.Num() / 2];
+	}
+
+	double Max() const { return Milliseconds.Num() > 0 ? FMath::Max(Milliseconds) : 0.0; }
+};
+
+static void SetConsoleVariable(const TCHAR* Name, const TCHAR* Value)
+{
+	if (IConsoleVariable* CVar = IConsoleManager::Get().FindConsoleVariable(Name))
+	{
+		CVar->Set(Value, ECVF_SetByCode);
+	}
+}
+
+static bool GetConsoleVariableBool(const TCHAR* Name)
+{
+	const IConsoleVariable* CVar = IConsoleManager::Get().FindConsoleVariable(Name);
+	return CVar != nullptr && CVar->GetBool();
+}
+
+static void SpawnBenchmarkActors(UWorld* World, const TArray<UClass*>& Classes, int32 NumActors, int32 NumSplinePoints, double Extent)
+{
+	FRandomStream Random(NumActors);
+	for (int32 Index = 0; Index < NumActors; ++Index)
+	{
+		const FVector Location(Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent), Random.FRandRange(0.0, Extent * 0.1));
+
+		AActor* Actor = World->SpawnActor<AActor>();
+		USceneComponent* Root = NewObject<USceneComponent>(Actor, TEXT("Root"));
+		Actor->SetRootComponent(Root);
+		Actor->AddInstanceComponent(Root);
+		Root->SetWorldLocation(Location);
+		Root->RegisterComponent();
+
+		UClass* Class = Classes[Index % Classes.Num()];
+		UActorComponent* Component = NewObject<UActorComponent>(Actor, Class);
+		if (USceneComponent* SceneComponent = Cast<USceneComponent>(Component))
+		{
+			SceneComponent->SetupAttachment(Root);
+		}
+		if (USplineComponent* Spline = Cast<USplineComponent>(Component))
+		{
+			Spline->ClearSplinePoints(false);
+			for (int32 PointIndex = 0; PointIndex < NumSplinePoints; ++PointIndex)
+			{
+				const FVector Point(PointIndex * 500.0, Random.FRandRange(-500.0, 500.0), Random.FRandRange(-100.0, 100.0));
+				Spline->AddSplinePoint(Point, ESplineCoordinateSpace::Local, false);
+			}
+			Spline->UpdateSpline();
+		}
+		Actor->AddInstanceComponent(Component);
+		Component->RegisterComponent();
+	}
+}
+
+// Draws captured frames again without a world. Measures only what happens after visualizers, coalescing included when enabled.
+static int32 ReplayCapture(const FString& Path, int32 NumFrames, double MaxFrameMs)
+{
+	FCaptureReplay Replay;
+	FString Error;
+	if (!Replay.Open(Path, Error))
+	{
+		UE_LOGFMT(LogDrawAllVisualizers, Error, "Benchmark: can't replay {0}: {1}", Path, Error);
+		return 1;
+	}
+
+	const bool bCoalesce = GetConsoleVariableBool(TEXT("DrawAllVisualizers.Coalesce"));
+	FCountingPDI PDI(nullptr);
+	FRecordedGeometry CoalescedGeometry;
+	FCaptureReplayCounts Counts;
+	FBenchmarkTimings FrameTimings;
+
+	// Every captured frame is one replayed frame, repeated until NumFrames.
+	const TArray<FCaptureReplay::FView>& Views = Replay.GetViews();
+	for (int32 Frame = 0; Frame < NumFrames && Views.Num() > 0; ++Frame)
+	{
+		const int32 CapturedFrame = Frame % FMath::Max(Replay.NumFrames(), 1);
+		PDI.Reset();
+		Counts = FCaptureReplayCounts();
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (const FCaptureReplay::FView& View : Views)
+		{
+			if (View.Frame != CapturedFrame) continue;
+
+			if (bCoalesce)
+			{
+				FCoalescedCounts CoalescedCounts;
+				FCoalescingPDI CoalescingPDI(nullptr, &PDI, CoalescedGeometry);
+				Replay.ReplayView(View, &CoalescingPDI, Counts);
+				CoalescingPDI.Flush(CoalescedCounts);
+			}
+			else
+			{
+				Replay.ReplayView(View, &PDI, Counts);
+			}
+		}
+		FrameTimings.Add(FPlatformTime::Seconds() - StartTime);
+	}
+
+	const double FrameMs = FrameTimings.Median();
+	UE_LOGFMT(LogDrawAllVisualizers, Display,
+		"Benchmark replay of {0}: {1} captured frames, {2} calls. Frame median {3} ms max {4} ms, lines {5} of {6}, points {7} of {8}, skipped {9}, HUD {10}",
+		Path, Replay.NumFrames(), Replay.NumCalls(), FrameMs, FrameTimings.Max(), PDI.NumLines, Counts.Lines, PDI.NumPoints, Counts.Points,
+		Counts.Skipped, Counts.HUD);
+
+	if (MaxFrameMs > 0.0 && FrameMs > MaxFrameMs)
+	{
+		UE_LOGFMT(LogDrawAllVisualizers, Error, "Benchmark: frame {0} ms is over the limit {1} ms", FrameMs, MaxFrameMs);
+		return 1;
+	}
+	return 0;
+}
+}
+
+UDrawAllVisualizersBenchmarkCommandlet::UDrawAllVisualizersBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UDrawAllVisualizersBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace DrawAllVisualizers;
+
+	int32 NumActors = 1000;
+	int32 NumSplinePoints = 8;
+	int32 NumFrames = 200;
+	int32 NumRebuilds = 10;
+	float SelectPercent = 10.f;
+	double Extent = 50000.0;
+	double MaxRebuildMs = 0.0;
+	double MaxFrameMs = 0.0;
+	FString ClassNames = TEXT("SplineComponent,PointLightComponent,SpotLightComponent,AudioComponent");
+	FString CsvPath = FPaths::ProjectSavedDir() / TEXT("DrawAllVisualizers") / TEXT("Benchmark.csv");
+
+	FParse::Value(*Params, TEXT("Actors="), NumActors);
+	FParse::Value(*Params, TEXT("SplinePoints="), NumSplinePoints);
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("Rebuilds="), NumRebuilds);
+	FParse::Value(*Params, TEXT("SelectPercent="), SelectPercent);
+	FParse::Value(*Params, TEXT("Extent="), Extent);
+	FParse::Value(*Params, TEXT("MaxRebuildMs="), MaxRebuildMs);
+	FParse::Value(*Params, TEXT("MaxFrameMs="), MaxFrameMs);
+	FParse::Value(*Params, TEXT("Classes="), ClassNames, false);
+	FParse::Value(*Params, TEXT("Csv="), CsvPath);
+
+	FString ReplayPath;
+	if (FParse::Value(*Params, TEXT("Replay="), ReplayPath))
+	{
+		return ReplayCapture(ReplayPath, NumFrames, MaxFrameMs);
+	}
+
+	// Settings only, there is no cvar for a class list. Not saved.
+	FString ParallelVisualizers;
+	if (FParse::Value(*Params, TEXT("ParallelVisualizers="), ParallelVisualizers, false))
+	{
+		TArray<FString> ParallelVisualizerArray;
+		ParallelVisualizers.ParseIntoArray(ParallelVisualizerArray, TEXT(","));
+		UDrawAllVisualizersSettings* Settings = GetMutableDefault<UDrawAllVisualizersSettings>();
+		Settings->ParallelVisualizers.Reset();
+		for (const FString& ClassName : ParallelVisualizerArray)
+		{
+			Settings->ParallelVisualizers.Add(FName(*ClassName));
+		}
+	}
+
+	// Registers the stock visualizers. Normally loaded by the editor UI.
+	FModuleManager::Get().LoadModule(TEXT("ComponentVisualizers"));
+
+	TArray<UClass*> Classes;
+	TArray<FString> ClassNameArray;
+	ClassNames.ParseIntoArray(ClassNameArray, TEXT(","));
+	for (const FString& ClassName : ClassNameArray)
+	{
+		UClass* Class = FindFirstObject<UClass>(*ClassName, EFindFirstObjectOptions::NativeFirst);
+		if (Class == nullptr || !Class->IsChildOf<UActorComponent>() || Class->HasAnyClassFlags(CLASS_Abstract))
+		{
+			UE_LOGFMT(LogDrawAllVisualizers, Error, "Benchmark: {0} is not a component class", ClassName);
+			return 1;
+		}
+		if (!GUnrealEd->FindComponentVisualizer(Class).IsValid())
+		{
+			UE_LOGFMT(LogDrawAllVisualizers, Warning, "Benchmark: {0} has no registered visualizer", ClassName);
+		}
+		Classes.Add(Class);
+	}
+	if (Classes.Num() == 0 || NumActors <= 0 || NumFrames <= 0)
+	{
+		UE_LOGFMT(LogDrawAllVisualizers, Error, "Benchmark: nothing to do");
+		return 1;
+	}
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, TEXT("DrawAllVisualizersBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Editor);
+	WorldContext.SetCurrentWorld(World);
+
+	const double SpawnStart = FPlatformTime::Seconds();
+	SpawnBenchmarkActors(World, Classes, NumActors, NumSplinePoints, Extent);
+	UE_LOGFMT(LogDrawAllVisualizers, Display, "Benchmark: spawned {0} actors in {1} s", NumActors, FPlatformTime::Seconds() - SpawnStart);
+
+	// Full rebuilds in one go, the time sliced path would only measure the budget.
+	SetConsoleVariable(TEXT("DrawAllVisualizers.RebuildBudgetMs"), TEXT("0"));
+	SetConsoleVariable(TEXT("DrawAllVisualizers.Enabled"), TEXT("1"));
+
+	// View from above, looking at the middle of the area.
+	FSceneViewFamilyContext ViewFamily(FSceneViewFamily::ConstructionValues(nullptr, World->Scene, FEngineShowFlags(ESFIM_Editor)));
+	FSceneViewInitOptions ViewInitOptions;
+	ViewInitOptions.ViewFamily = &ViewFamily;
+	ViewInitOptions.SetViewRectangle(FIntRect(FIntPoint::ZeroValue, FBenchmarkRenderTarget().GetSizeXY()));
+	ViewInitOptions.ViewOrigin = FVector(-Extent, 0.0, Extent * 0.5);
+	ViewInitOptions.ViewRotationMatrix = FInverseRotationMatrix(FRotator(-25.0, 0.0, 0.0))
+		* FMatrix(FPlane(0, 0, 1, 0), FPlane(1, 0, 0, 0), FPlane(0, 1, 0, 0), FPlane(0, 0, 0, 1));
+	ViewInitOptions.ProjectionMatrix = FReversedZPerspectiveMatrix(FMath::DegreesToRadians(45.0), 1920.f, 1080.f, GNearClippingPlane);
+	FSceneView* View = new FSceneView(ViewInitOptions);
+	ViewFamily.Views.Add(View);
+
+	FBenchmarkRenderTarget RenderTarget;
+	FCountingPDI PDI(View);
+
+	TSharedRef<FDrawAllVisualizersEdMode> Mode = MakeShared<FDrawAllVisualizersEdMode>();
+	Mode->Initialize();
+
+	// Mode manager is bypassed, entering binds the selection and world change delegates.
+	Mode->Enter();
+
+	// Warm up frame builds the cache.
+	++GFrameCounter;
+	Mode->Render(View, nullptr, &PDI);
+
+	FBenchmarkTimings RebuildTimings;
+	for (int32 Index = 0; Index < NumRebuilds; ++Index)
+	{
+		const double Start = FPlatformTime::Seconds();
+		Mode->RebuildCachedVisualizers();
+		RebuildTimings.Add(FPlatformTime::Seconds() - Start);
+	}
+
+	FBenchmarkTimings RenderTimings;
+	FBenchmarkTimings HUDTimings;
+	FBenchmarkTimings FrameTimings;
+	int64 NumLinesPerFrame = 0;
+	int64 NumPointsPerFrame = 0;
+	int64 NumSpritesPerFrame = 0;
+	int64 NumMeshesPerFrame = 0;
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		++GFrameCounter;
+		PDI.Reset();
+
+		// Fresh canvas every frame so batched HUD elements don't pile up.
+		FCanvas Canvas(&RenderTarget, nullptr, World, GMaxRHIFeatureLevel);
+
+		const double Start = FPlatformTime::Seconds();
+		Mode->Render(View, nullptr, &PDI);
+		const double RenderEnd = FPlatformTime::Seconds();
+		Mode->DrawHUD(nullptr, nullptr, View, &Canvas);
+		const double End = FPlatformTime::Seconds();
+
+		RenderTimings.Add(RenderEnd - Start);
+		HUDTimings.Add(End - RenderEnd);
+		FrameTimings.Add(End - Start);
+
+		NumLinesPerFrame = PDI.NumLines;
+		NumPointsPerFrame = PDI.NumPoints;
+		NumSpritesPerFrame = PDI.NumSprites;
+		NumMeshesPerFrame = PDI.NumMeshes;
+	}
+
+	// Selection change goes through the same event as in editor. Timed until the frame that picks it up has been drawn.
+	TArray<AActor*> SelectionCandidates;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		SelectionCandidates.Add(*It);
+	}
+	const int32 NumSelected = FMath::Clamp(FMath::RoundToInt(SelectionCandidates.Num() * SelectPercent / 100.f), 1, SelectionCandidates.Num());
+
+	FBenchmarkTimings SelectTimings;
+	USelection* Selection = GEditor->GetSelectedActors();
+	for (int32 Index = 0; Index < 10; ++Index)
+	{
+		++GFrameCounter;
+		PDI.Reset();
+
+		const double Start = FPlatformTime::Seconds();
+		Selection->BeginBatchSelectOperation();
+		if (Index % 2 == 0)
+		{
+			for (int32 ActorIndex = 0; ActorIndex < NumSelected; ++ActorIndex)
+			{
+				Selection->Select(SelectionCandidates[ActorIndex]);
+			}
+		}
+		else
+		{
+			Selection->DeselectAll();
+		}
+		Selection->EndBatchSelectOperation();
+		Mode->Render(View, nullptr, &PDI);
+		SelectTimings.Add(FPlatformTime::Seconds() - Start);
+	}
+	Selection->DeselectAll();
+
+	const int32 NumCached = Mode->CachedVisualizers.Num();
+	const int32 NumRetained = Mode->CachedVisualizers.NumGeometries();
+	SIZE_T CacheBytes = Mode->CachedVisualizers.GetAllocatedSize() + Mode->LiveVisualizersByWorld.GetAllocatedSize() + Mode->SplineRenderer.GetAllocatedSize();
+	for (const TArray<FLiveVisualizer>& LiveVisualizers : Mode->LiveVisualizersByWorld)
+	{
+		CacheBytes += LiveVisualizers.GetAllocatedSize();
+	}
+
+	const double RebuildMs = RebuildTimings.Median();
+	const double FrameMs = FrameTimings.Median();
+
+	const FString Header = TEXT("Actors,Classes,SplinePoints,Frames,Cached,Retained,Culling,NoCache,ParallelScan,ParallelDraw,SplineFastPath,Workers,"
+		"RebuildMedianMs,RebuildMaxMs,RenderMedianMs,HUDMedianMs,FrameMedianMs,FrameMaxMs,SelectMedianMs,"
+		"Lines,Points,Sprites,Meshes,RetainedEntries,CacheKiB\n");
+	const FString Row = FString::Printf(TEXT("%d,%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%lld,%lld,%lld,%lld,%d,%.1f\n"),
+		NumActors, *ClassNames.Replace(TEXT(","), TEXT(" ")), NumSplinePoints, NumFrames, NumCached,
+		GetConsoleVariableBool(TEXT("DrawAllVisualizers.Retained")), GetConsoleVariableBool(TEXT("DrawAllVisualizers.Culling")),
+		GetConsoleVariableBool(TEXT("DrawAllVisualizers.NoCache")), GetConsoleVariableBool(TEXT("DrawAllVisualizers.ParallelScan")),
+		GetConsoleVariableBool(TEXT("DrawAllVisualizers.ParallelDraw")), GetConsoleVariableBool(TEXT("DrawAllVisualizers.SplineFastPath")),
+		FTaskGraphInterface::Get().GetNumWorkerThreads(),
+		RebuildMs, RebuildTimings.Max(), RenderTimings.Median(), HUDTimings.Median(), FrameMs, FrameTimings.Max(), SelectTimings.Median(),
+		NumLinesPerFrame, NumPointsPerFrame, NumSpritesPerFrame, NumMeshesPerFrame, NumRetained, CacheBytes / 1024.0);
+
+	// Appended so runs with different parameters end up in one file.
+	const bool bWriteHeader = !FPaths::FileExists(CsvPath);
+	FFileHelper::SaveStringToFile(bWriteHeader ? Header + Row : Row, *CsvPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM,
+	                              &IFileManager::Get(), bWriteHeader ? FILEWRITE_None : FILEWRITE_Append);
+	UE_LOGFMT(LogDrawAllVisualizers, Display, "Benchmark: {0}{1}", Header, Row);
+
+	// Exit empties the cache and unbinds everything before the world goes away. Disabled first so it doesn't try to activate again.
+	SetConsoleVariable(TEXT("DrawAllVisualizers.Enabled"), TEXT("0"));
+	Mode->Exit();
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	int32 Result = 0;
+	if (MaxRebuildMs > 0.0 && RebuildMs > MaxRebuildMs)
+	{
+		UE_LOGFMT(LogDrawAllVisualizers, Error, "Benchmark: rebuild {0} ms is over the limit {1} ms", RebuildMs, MaxRebuildMs);
+		Result = 1;
+	}
+	if (MaxFrameMs > 0.0 && FrameMs > MaxFrameMs)
+	{
+		UE_LOGFMT(LogDrawAllVisualizers, Error, "Benchmark: frame {0} ms is over the limit {1} ms", FrameMs, MaxFrameMs);
+		Result = 1;
+	}
+	return Result;
+}
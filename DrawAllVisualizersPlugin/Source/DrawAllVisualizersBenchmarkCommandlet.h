@@ -0,0 +1,59 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DrawAllVisualizersBenchmarkCommandlet.generated.h"
+
+// Headless benchmark for CI. Builds a transient world full of visualized components and drives the EdMode directly,
+// because the subsystem that normally registers it is not created for commandlets. Results are appended to a CSV file.
+//
+// UnrealEditor-Cmd.exe Project.uproject -run=DrawAllVisualizersBenchmark -nullrhi -unattended
+//	-Actors=1000				Actors to spawn, one visualized component each.
+//	-Classes=SplineComponent,PointLightComponent	Component classes to spawn, cycled through.
+//	-SplinePoints=8				Points per spline.
+//	-Extent=50000				Half size of the area actors are spread over.
+//	-Frames=200					Frames to draw after warming up.
+//	-Rebuilds=10				Full cache rebuilds to time.
+//	-SelectPercent=10			Percentage of actors selected when timing selection changes.
+//	-Csv=Path					Defaults to Saved/DrawAllVisualizers/Benchmark.csv.
+//	-ParallelVisualizers=SplineComponent	Overrides Parallel Visualizers setting for DrawAllVisualizers.ParallelDraw.
+//	-MaxRebuildMs= -MaxFrameMs=	Fail with non zero exit code when median goes over these.
+//	-Replay=Path				Replay a DrawAllVisualizers.Capture file -Frames times instead. No world is created, only -MaxFrameMs applies.
+// Plugin cvars can be set with -dpcvars=DrawAllVisualizers.Retained=1,DrawAllVisualizers.Culling=0
+UCLASS()
+class UDrawAllVisualizersBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDrawAllVisualizersBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,308 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DrawAllVisualizersCache.h"
+#include "ComponentVisualizer.h"
+#include "Components/ActorComponent.h"
+#include "GameFramework/Actor.h"
+#include "Engine/World.h"
+
+namespace DrawAllVisualizers
+{
+FCachedVisualizerIdentity MakeIdentity(const UActorComponent* Component)
+{
+	return {FObjectKey(Component->GetOwner()), Component->GetFName()};
+}
+
+void FVisualizerCache::Reset()
+{
+	Types.Reset();
+	TypeIndexByClass.Reset();
+	ClassResolutions.Reset();
+	SlotByComponent.Reset();
+	ComponentByIdentity.Reset();
+	Worlds.Reset();
+	WorldIndexByWorld.Reset();
+	Geometries.Reset();
+	NumEntries = 0;
+	++EntriesVersion;
+}
+
+void FVisualizerCache::Empty()
+{
+	Types.Empty();
+	TypeIndexByClass.Empty();
+	ClassResolutions.Empty();
+	SlotByComponent.Empty();
+	ComponentByIdentity.Empty();
+	Worlds.Empty();
+	WorldIndexByWorld.Empty();
+	Geometries.Empty();
+	NumEntries = 0;
+	++EntriesVersion;
+}
+
+bool FVisualizerCache::Contains(UActorComponent* Component) const
+{
+	return SlotByComponent.Contains(Component);
+}
+
+int32 FVisualizerCache::FindTypeIndex(const UClass* Class) const
+{
+	const int32* TypeIndex = TypeIndexByClass.Find(Class);
+	return TypeIndex != nullptr ? *TypeIndex : INDEX_NONE;
+}
+
+int32 FVisualizerCache::AddType(const UClass* Class, const TSharedPtr<FComponentVisualizer>& Visualizer, const FVisualizerCullParams& CullParams, bool bRetainable,
+                                bool bParallel)
+{
+	check(FindTypeIndex(Class) == INDEX_NONE);
+
+	const int32 TypeIndex = Types.AddDefaulted();
+	FVisualizerType& Type = Types[TypeIndex];
+	Type.Visualizer = Visualizer;
+	Type.ClassName = Class->GetFName();
+	Type.TraceName = Class->GetName();
+	Type.CullParams = CullParams;
+	Type.bRetainable = bRetainable;
+	Type.bParallel = bParallel;
+
+	TypeIndexByClass.Add(Class, TypeIndex);
+	return TypeIndex;
+}
+
+void FVisualizerCache::Add(int32 TypeIndex, UActorComponent* Component, ECachedVisualizerFlags Flags)
+{
+	if (SlotByComponent.Contains(Component)) return;
+
+	UWorld* World = Component->GetWorld();
+	if (World == nullptr || World->WorldType == EWorldType::EditorPreview) return;
+
+	int32 WorldIndex = FindWorldIndex(World);
+	if (WorldIndex == INDEX_NONE)
+	{
+		WorldIndex = Worlds.Add(World);
+		WorldIndexByWorld.Add(World, WorldIndex);
+	}
+
+	// Construction script reruns destroy the old component before the new one is seen here.
+	const FCachedVisualizerIdentity Identity = MakeIdentity(Component);
+	const TWeakObjectPtr<UActorComponent> Previous = ComponentByIdentity.FindRef(Identity);
+	if (!Previous.IsExplicitlyNull() && !Previous.IsValid() && TakeOver(Previous, Component, TypeIndex))
+	{
+		// Selection belongs to the actor and survives reconstruction. Visibility is what the new component says.
+		const FCachedVisualizerSlot& Slot = SlotByComponent[Component];
+		FCachedVisualizer& Entry = Types[Slot.TypeIndex].Entries[Slot.EntryIndex];
+		Entry.Flags = (Entry.Flags & ~ECachedVisualizerFlags::Hidden) | (Flags & ECachedVisualizerFlags::Hidden);
+		return;
+	}
+
+	TArray<FCachedVisualizer>& Entries = Types[TypeIndex].Entries;
+	const int32 EntryIndex = Entries.Add({Component, Flags, INDEX_NONE, WorldIndex});
+	SlotByComponent.Add(Component, {TypeIndex, EntryIndex, Identity});
+	ComponentByIdentity.Add(Identity, Component);
+	++NumEntries;
+	++EntriesVersion;
+}
+
+bool FVisualizerCache::TakeOver(TWeakObjectPtr<UActorComponent> Previous, UActorComponent* Component, int32 TypeIndex)
+{
+	if (Component == nullptr || SlotByComponent.Contains(Component)) return false;
+
+	const FCachedVisualizerSlot* PreviousSlot = SlotByComponent.Find(Previous);
+	if (PreviousSlot == nullptr || TypeIndex != PreviousSlot->TypeIndex) return false;
+
+	FCachedVisualizer& Entry = Types[PreviousSlot->TypeIndex].Entries[PreviousSlot->EntryIndex];
+	if (FindWorldIndex(Component->GetWorld()) != Entry.WorldIndex) return false;
+
+	FCachedVisualizerSlot Slot = *PreviousSlot;
+	SlotByComponent.Remove(Previous);
+	if (ComponentByIdentity.FindRef(Slot.Identity) == Previous) ComponentByIdentity.Remove(Slot.Identity);
+
+	Slot.Identity = MakeIdentity(Component);
+	SlotByComponent.Add(Component, Slot);
+	ComponentByIdentity.Add(Slot.Identity, Component);
+	Entry.Component = Component;
+
+	// New component can draw differently. Buffer is kept and recorded again.
+	if (Entry.GeometryIndex != INDEX_NONE)
+	{
+		Geometries[Entry.GeometryIndex].bDirty = true;
+	}
+
+	// Entries stay where they are, but live visualizers hold the old component pointer.
+	++EntriesVersion;
+	return true;
+}
+
+UActorComponent* FVisualizerCache::FindReconstructed(const TWeakObjectPtr<UActorComponent>& Previous) const
+{
+	const FCachedVisualizerSlot* Slot = SlotByComponent.Find(Previous);
+	if (Slot == nullptr) return nullptr;
+
+	AActor* Owner = Cast<AActor>(Slot->Identity.Owner.ResolveObjectPtr());
+	if (!IsValid(Owner)) return nullptr;
+
+	// Components are outered to their owner, so this is a hash lookup.
+	UActorComponent* Component = FindObjectFast<UActorComponent>(Owner, Slot->Identity.Name);
+	return IsValid(Component) && Component->GetOwner() == Owner ? Component : nullptr;
+}
+
+void FVisualizerCache::RemoveAtSwap(int32 TypeIndex, int32 EntryIndex)
+{
+	TArray<FCachedVisualizer>& Entries = Types[TypeIndex].Entries;
+	const FCachedVisualizerSlot* Slot = SlotByComponent.Find(Entries[EntryIndex].Component);
+	if (Slot != nullptr && ComponentByIdentity.FindRef(Slot->Identity) == Entries[EntryIndex].Component) ComponentByIdentity.Remove(Slot->Identity);
+	SlotByComponent.Remove(Entries[EntryIndex].Component);
+	if (Entries[EntryIndex].GeometryIndex != INDEX_NONE)
+	{
+		Geometries.RemoveAt(Entries[EntryIndex].GeometryIndex);
+	}
+
+	Entries.RemoveAtSwap(EntryIndex, 1, false);
+	if (Entries.IsValidIndex(EntryIndex))
+	{
+		SlotByComponent[Entries[EntryIndex].Component].EntryIndex = EntryIndex;
+	}
+	--NumEntries;
+	++EntriesVersion;
+}
+
+int32 FVisualizerCache::RemoveWorld(const UWorld* World)
+{
+	const int32 WorldIndex = FindWorldIndex(World);
+	if (WorldIndex == INDEX_NONE) return 0;
+
+	const int32 NumRemoved = RemoveAll([WorldIndex](const FCachedVisualizer& Entry, const UActorComponent*)
+	{
+		return Entry.WorldIndex == WorldIndex;
+	});
+
+	Worlds.RemoveAt(WorldIndex);
+	WorldIndexByWorld.Remove(World);
+	return NumRemoved;
+}
+
+void FVisualizerCache::Remove(UActorComponent* Component)
+{
+	if (const FCachedVisualizerSlot* Slot = SlotByComponent.Find(Component))
+	{
+		RemoveAtSwap(Slot->TypeIndex, Slot->EntryIndex);
+	}
+}
+
+int32 FVisualizerCache::SetActorSelected(const AActor* Actor, bool bSelected)
+{
+	// Actor already knows its components and components know their slots, no need for a separate actor index to keep in sync.
+	TInlineComponentArray<UActorComponent*> Components;
+	Actor->GetComponents(Components, false);
+
+	int32 NumChanged = 0;
+	for (UActorComponent* Component : Components)
+	{
+		const FCachedVisualizerSlot* Slot = SlotByComponent.Find(Component);
+		if (Slot == nullptr) continue;
+
+		FCachedVisualizer& Entry = Types[Slot->TypeIndex].Entries[Slot->EntryIndex];
+		if (Entry.IsSelected() == bSelected) continue;
+
+		if (bSelected) EnumAddFlags(Entry.Flags, ECachedVisualizerFlags::Selected);
+		else EnumRemoveFlags(Entry.Flags, ECachedVisualizerFlags::Selected);
+		++NumChanged;
+	}
+	return NumChanged;
+}
+
+bool FVisualizerCache::SetHiddenFlags(UActorComponent* Component, ECachedVisualizerFlags HiddenFlags)
+{
+	const FCachedVisualizerSlot* Slot = SlotByComponent.Find(Component);
+	if (Slot == nullptr) return false;
+
+	FCachedVisualizer& Entry = Types[Slot->TypeIndex].Entries[Slot->EntryIndex];
+	const ECachedVisualizerFlags NewFlags = (Entry.Flags & ~ECachedVisualizerFlags::Hidden) | (HiddenFlags & ECachedVisualizerFlags::Hidden);
+	if (NewFlags == Entry.Flags) return false;
+
+	Entry.Flags = NewFlags;
+	return true;
+}
+
+FRetainedGeometry& FVisualizerCache::FindOrAddGeometry(FCachedVisualizer& Entry)
+{
+	if (Entry.GeometryIndex == INDEX_NONE)
+	{
+		Entry.GeometryIndex = Geometries.Add(FRetainedGeometry());
+	}
+	return Geometries[Entry.GeometryIndex];
+}
+
+void FVisualizerCache::MarkGeometryDirty(UActorComponent* Component)
+{
+	const FCachedVisualizerSlot* Slot = SlotByComponent.Find(Component);
+	if (Slot == nullptr) return;
+
+	const int32 GeometryIndex = Types[Slot->TypeIndex].Entries[Slot->EntryIndex].GeometryIndex;
+	if (GeometryIndex != INDEX_NONE)
+	{
+		Geometries[GeometryIndex].bDirty = true;
+	}
+}
+
+void FVisualizerCache::MarkAllGeometryDirty()
+{
+	for (FRetainedGeometry& Geometry : Geometries)
+	{
+		Geometry.bDirty = true;
+	}
+}
+
+void FVisualizerCache::EmptyGeometries()
+{
+	Geometries.Empty();
+	for (FVisualizerType& Type : Types)
+	{
+		for (FCachedVisualizer& Entry : Type.Entries)
+		{
+			Entry.GeometryIndex = INDEX_NONE;
+		}
+	}
+}
+
+SIZE_T FVisualizerCache::GetAllocatedSize() const
+{
+	SIZE_T Size = Types.GetAllocatedSize() + TypeIndexByClass.GetAllocatedSize() + ClassResolutions.GetAllocatedSize()
+		+ SlotByComponent.GetAllocatedSize() + ComponentByIdentity.GetAllocatedSize() + Worlds.GetAllocatedSize() + WorldIndexByWorld.GetAllocatedSize() + Geometries.GetAllocatedSize();
+	for (const FVisualizerType& Type : Types)
+	{
+		Size += Type.Entries.GetAllocatedSize();
+	}
+	for (const FRetainedGeometry& Geometry : Geometries)
+	{
+		Size += Geometry.Geometry.GetAllocatedSize();
+	}
+	return Size;
+}
+}
@@ -0,0 +1,280 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "DrawAllVisualizersRecordingPDI.h"
+
+class AActor;
+class FComponentVisualizer;
+class UActorComponent;
+class UWorld;
+
+namespace DrawAllVisualizers
+{
+// Culling settings resolved for single component class.
+struct FVisualizerCullParams
+{
+	float MaxDrawDistance = 0.f;
+	float MinScreenSize = 0.f;
+	bool bFrustumCulling = true;
+};
+
+enum class ECachedVisualizerFlags : uint8
+{
+	None = 0,
+
+	// Visualizers for selected actors are skipped. Let default drawing system handle those.
+	Selected = 1 << 0,
+
+	// Reasons the component is hidden in the editor. Evaluated when those states change, not when drawing.
+	HiddenLevel = 1 << 1,
+	HiddenTemporarily = 1 << 2,
+	HiddenLayer = 1 << 3,
+	HiddenDataLayer = 1 << 4,
+	// Level or World Partition cell of the actor is being unloaded.
+	Unloaded = 1 << 5,
+	HiddenComponent = 1 << 6,
+
+	Hidden = HiddenLevel | HiddenTemporarily | HiddenLayer | HiddenDataLayer | Unloaded | HiddenComponent,
+
+	// Entries with any of these are not drawn by this.
+	NotDrawn = Selected | Hidden,
+};
+ENUM_CLASS_FLAGS(ECachedVisualizerFlags)
+
+// Dense per type arrays of these are walked every frame. Anything only needed when adding or removing goes to the side maps instead.
+struct FCachedVisualizer
+{
+	TWeakObjectPtr<UActorComponent> Component;
+	ECachedVisualizerFlags Flags = ECachedVisualizerFlags::None;
+
+	// Index to FVisualizerCache retained geometries. Only allocated when drawn in retained mode.
+	int32 GeometryIndex = INDEX_NONE;
+
+	// Bucket of the world the component is in. Resolved once when added, components don't move between worlds.
+	int32 WorldIndex = INDEX_NONE;
+
+	bool IsSelected() const { return EnumHasAnyFlags(Flags, ECachedVisualizerFlags::Selected); }
+	bool IsHidden() const { return EnumHasAnyFlags(Flags, ECachedVisualizerFlags::Hidden); }
+	bool IsDrawn() const { return !EnumHasAnyFlags(Flags, ECachedVisualizerFlags::NotDrawn); }
+};
+
+// All cached components of single component class. Everything that is the same for all of them lives here instead of in the entries.
+struct FVisualizerType
+{
+	TSharedPtr<FComponentVisualizer> Visualizer;
+	FName ClassName;
+	FVisualizerCullParams CullParams;
+
+	// False for visualizers whose output depends on the view. Those are always drawn directly.
+	bool bRetainable = true;
+
+	// Listed in settings as safe to draw on worker threads. Cleared if it turns out to draw something that can't be recorded.
+	bool bParallel = false;
+
+	// Stock spline visualizer. Unselected splines are drawn by FSplineRenderer instead, except in hit proxy passes.
+	bool bSplineFastPath = false;
+
+	TArray<FCachedVisualizer> Entries;
+
+	// Name for the per type Insights scope. Dynamic trace scopes need a string.
+	FString TraceName;
+
+	// Updated while drawing, for the on screen debugs. Live count is from the latest prepare, cycles are summed over all views of a frame.
+	int32 NumLive = 0;
+	uint64 DrawCycles = 0;
+	uint64 DrawCyclesLastFrame = 0;
+};
+
+// Result of resolving component class to visualizer type. Non negative values are type indices.
+namespace EClassResolution
+{
+enum Type : int32
+{
+	Unresolved = -1,
+	NoVisualizer = -2,
+	Ignored = -3,
+};
+}
+
+// Owning actor and component name. Stays the same when construction script reruns replace the component with a new one.
+struct FCachedVisualizerIdentity
+{
+	FObjectKey Owner;
+	FName Name;
+
+	bool operator==(const FCachedVisualizerIdentity& Other) const { return Owner == Other.Owner && Name == Other.Name; }
+	friend uint32 GetTypeHash(const FCachedVisualizerIdentity& Identity) { return HashCombine(GetTypeHash(Identity.Owner), GetTypeHash(Identity.Name)); }
+};
+
+struct FCachedVisualizerSlot
+{
+	int32 TypeIndex = INDEX_NONE;
+	int32 EntryIndex = INDEX_NONE;
+	FCachedVisualizerIdentity Identity;
+};
+
+// Entry that passed the view independent checks this frame. Only valid while cache entries version stays the same.
+struct FLiveVisualizer
+{
+	const UActorComponent* Component = nullptr;
+	int32 TypeIndex = INDEX_NONE;
+	int32 EntryIndex = INDEX_NONE;
+};
+
+struct FPrioritizedVisualizer
+{
+	float Priority = 0.f;
+	int32 LiveIndex = INDEX_NONE;
+};
+
+// Entries deferred by the draw budget in one view. Viewports see different entries, so each ages its own.
+struct FDrawBudgetViewState
+{
+	// Truncated GFrameCounter of when each component was first deferred. Rebuilt every pass, so only what is still deferred is kept.
+	TMap<FObjectKey, uint32> DeferredSince;
+
+	// Frame the current round of turns started, 0 when none is running. Round ends once all that was deferred by then has been drawn.
+	uint32 RoundStartFrame = 0;
+	uint64 LastUsedFrame = 0;
+};
+
+// Entries are grouped by component class into dense arrays so drawing can go through one visualizer type at a time.
+// Lookup by component is only needed when adding or removing, so it's kept on the side and not touched when drawing.
+class FVisualizerCache
+{
+public:
+	void Reset();
+	void Empty();
+
+	int32 Num() const { return NumEntries; }
+
+	// Changes whenever entries are added, removed or moved around.
+	uint32 GetEntriesVersion() const { return EntriesVersion; }
+	bool Contains(UActorComponent* Component) const;
+	const FCachedVisualizerSlot* FindSlot(UActorComponent* Component) const { return SlotByComponent.Find(Component); }
+
+	// Pointer keyed so it's cheap enough for every constructed object. Must be reset when classes can get garbage collected.
+	int32 FindResolution(const UClass* Class) const
+	{
+		const int32* Resolution = ClassResolutions.Find(Class);
+		return Resolution != nullptr ? *Resolution : EClassResolution::Unresolved;
+	}
+	void AddResolution(const UClass* Class, int32 Resolution) { ClassResolutions.Add(Class, Resolution); }
+	void ResetResolutions() { ClassResolutions.Reset(); }
+
+	int32 FindTypeIndex(const UClass* Class) const;
+	int32 AddType(const UClass* Class, const TSharedPtr<FComponentVisualizer>& Visualizer, const FVisualizerCullParams& CullParams, bool bRetainable,
+	              bool bParallel);
+
+	// Worlds get small indices when their first entry is added, so entries can be bucketed per world without resolving it every frame.
+	int32 FindWorldIndex(const UWorld* World) const
+	{
+		const int32* WorldIndex = WorldIndexByWorld.Find(World);
+		return WorldIndex != nullptr ? *WorldIndex : INDEX_NONE;
+	}
+	int32 GetMaxWorldIndex() const { return Worlds.GetMaxIndex(); }
+	int32 NumWorlds() const { return Worlds.Num(); }
+
+	// Drops all entries of the world without touching the components. Returns number of entries removed.
+	int32 RemoveWorld(const UWorld* World);
+
+	// Does nothing if component is already cached or is not in a world that can be drawn.
+	// Takes over the slot of a destroyed component with the same identity instead of adding a new entry. Only hidden flags are taken from Flags then.
+	void Add(int32 TypeIndex, UActorComponent* Component, ECachedVisualizerFlags Flags = ECachedVisualizerFlags::None);
+
+	// Rebinds the slot of the previous component to the new one, keeping flags, retained geometry buffer and draw order.
+	// Hidden flags may not apply to the new component, callers compute them again.
+	// Fails if the new component is already cached, is in another world or TypeIndex, resolved from its class, is not the slot's type.
+	bool TakeOver(TWeakObjectPtr<UActorComponent> Previous, UActorComponent* Component, int32 TypeIndex);
+
+	// Live component with the identity of the cached one, if the owner still exists. For destroyed entries before sweeping them.
+	UActorComponent* FindReconstructed(const TWeakObjectPtr<UActorComponent>& Previous) const;
+
+	// Swaps last entry of the same type into removed slot. Iterate entries backwards if removing while iterating.
+	void RemoveAtSwap(int32 TypeIndex, int32 EntryIndex);
+	void Remove(UActorComponent* Component);
+
+	// Sets selected flag of cached components of the actor. Returns number of entries changed.
+	int32 SetActorSelected(const AActor* Actor, bool bSelected);
+
+	// Replaces hidden flags of the cached component. Returns true if they changed, false if not or if not cached.
+	bool SetHiddenFlags(UActorComponent* Component, ECachedVisualizerFlags HiddenFlags);
+
+	// Predicate gets the entry and its resolved component, which can be null for stale entries.
+	template <typename Predicate>
+	int32 RemoveAll(Predicate Pred);
+
+	FRetainedGeometry& FindOrAddGeometry(FCachedVisualizer& Entry);
+	const FRetainedGeometry* FindGeometry(const FCachedVisualizer& Entry) const
+	{
+		return Entry.GeometryIndex != INDEX_NONE ? &Geometries[Entry.GeometryIndex] : nullptr;
+	}
+	void MarkGeometryDirty(UActorComponent* Component);
+	void MarkAllGeometryDirty();
+	void EmptyGeometries();
+	int32 NumGeometries() const { return Geometries.Num(); }
+
+	TArray<FVisualizerType>& GetTypes() { return Types; }
+	const TArray<FVisualizerType>& GetTypes() const { return Types; }
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	TArray<FVisualizerType> Types;
+	TMap<FObjectKey, int32> TypeIndexByClass;
+	TMap<const UClass*, int32> ClassResolutions;
+	TMap<TWeakObjectPtr<UActorComponent>, FCachedVisualizerSlot> SlotByComponent;
+	TMap<FCachedVisualizerIdentity, TWeakObjectPtr<UActorComponent>> ComponentByIdentity;
+	TSparseArray<TWeakObjectPtr<UWorld>> Worlds;
+	TMap<FObjectKey, int32> WorldIndexByWorld;
+	TSparseArray<FRetainedGeometry> Geometries;
+	int32 NumEntries = 0;
+	uint32 EntriesVersion = 0;
+};
+
+template <typename Predicate>
+int32 FVisualizerCache::RemoveAll(Predicate Pred)
+{
+	const int32 NumBefore = NumEntries;
+	for (int32 TypeIndex = 0; TypeIndex < Types.Num(); ++TypeIndex)
+	{
+		TArray<FCachedVisualizer>& Entries = Types[TypeIndex].Entries;
+		for (int32 EntryIndex = Entries.Num() - 1; EntryIndex >= 0; --EntryIndex)
+		{
+			if (Pred(Entries[EntryIndex], Entries[EntryIndex].Component.Get()))
+			{
+				RemoveAtSwap(TypeIndex, EntryIndex);
+			}
+		}
+	}
+	return NumBefore - NumEntries;
+}
+}
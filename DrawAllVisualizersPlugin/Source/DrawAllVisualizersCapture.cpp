@@ -0,0 +1,256 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DrawAllVisualizersCapture.h"
+#include "DrawAllVisualizersEditorSubsystem.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Logging/StructuredLog.h"
+
+namespace DrawAllVisualizers
+{
+constexpr uint32 CaptureFileMagic = 0x43564144;	// "DAVC"
+constexpr uint32 CaptureFileVersion = 1;
+
+FCapturingPDI::FCapturingPDI(const FSceneView* InView, FPrimitiveDrawInterface* InTargetPDI, TArray<FCapturedCall>& InCalls)
+	: FPrimitiveDrawInterface(InView)
+	, TargetPDI(InTargetPDI)
+	, Calls(InCalls)
+{
+}
+
+void FCapturingPDI::RegisterDynamicResource(FDynamicPrimitiveResource* DynamicResource)
+{
+	Calls.Add({ECapturedCallKind::DynamicResource});
+	TargetPDI->RegisterDynamicResource(DynamicResource);
+}
+
+void FCapturingPDI::AddReserveLines(uint8 DepthPriorityGroup, int32 NumLines, bool bDepthBiased, bool bThickLines)
+{
+	FCapturedCall& Call = Calls.Add_GetRef({ECapturedCallKind::ReserveLines, DepthPriorityGroup});
+	Call.Count = NumLines;
+	if (bDepthBiased) Call.Flags |= ECapturedCallFlags::DepthBiased;
+	if (bThickLines) Call.Flags |= ECapturedCallFlags::ThickLines;
+	TargetPDI->AddReserveLines(DepthPriorityGroup, NumLines, bDepthBiased, bThickLines);
+}
+
+void FCapturingPDI::DrawSprite(const FVector& Position, float SizeX, float SizeY, const FTexture* Sprite, const FLinearColor& Color, uint8 DepthPriorityGroup,
+                               float U, float UL, float V, float VL, uint8 BlendMode, float OpacityMaskRefVal)
+{
+	FCapturedCall& Call = Calls.Add_GetRef({ECapturedCallKind::Sprite, DepthPriorityGroup});
+	Call.Size = SizeX;
+	Call.DepthBias = SizeY;
+	Call.Color = Color;
+	Call.Start = FVector3f(Position);
+	TargetPDI->DrawSprite(Position, SizeX, SizeY, Sprite, Color, DepthPriorityGroup, U, UL, V, VL, BlendMode, OpacityMaskRefVal);
+}
+
+void FCapturingPDI::DrawLine(const FVector& Start, const FVector& End, const FLinearColor& Color, uint8 DepthPriorityGroup, float Thickness, float DepthBias,
+                             bool bScreenSpace)
+{
+	Calls.Add({ECapturedCallKind::Line, DepthPriorityGroup, bScreenSpace ? ECapturedCallFlags::ScreenSpace : ECapturedCallFlags::None, 0, 0,
+	           Thickness, DepthBias, Color, FVector3f(Start), FVector3f(End)});
+	TargetPDI->DrawLine(Start, End, Color, DepthPriorityGroup, Thickness, DepthBias, bScreenSpace);
+}
+
+void FCapturingPDI::DrawTranslucentLine(const FVector& Start, const FVector& End, const FLinearColor& Color, uint8 DepthPriorityGroup, float Thickness,
+                                        float DepthBias, bool bScreenSpace)
+{
+	Calls.Add({ECapturedCallKind::TranslucentLine, DepthPriorityGroup, bScreenSpace ? ECapturedCallFlags::ScreenSpace : ECapturedCallFlags::None, 0, 0,
+	           Thickness, DepthBias, Color, FVector3f(Start), FVector3f(End)});
+	TargetPDI->DrawTranslucentLine(Start, End, Color, DepthPriorityGroup, Thickness, DepthBias, bScreenSpace);
+}
+
+void FCapturingPDI::DrawPoint(const FVector& Position, const FLinearColor& Color, float PointSize, uint8 DepthPriorityGroup)
+{
+	FCapturedCall& Call = Calls.Add_GetRef({ECapturedCallKind::Point, DepthPriorityGroup});
+	Call.Size = PointSize;
+	Call.Color = Color;
+	Call.Start = FVector3f(Position);
+	TargetPDI->DrawPoint(Position, Color, PointSize, DepthPriorityGroup);
+}
+
+int32 FCapturingPDI::DrawMesh(const FMeshBatch& Mesh)
+{
+	Calls.Add({ECapturedCallKind::Mesh});
+	return TargetPDI->DrawMesh(Mesh);
+}
+
+void FDrawCapture::Start(int32 InNumFrames, const FString& InPath)
+{
+	if (bRunning) Stop();
+
+	Calls.Reset();
+	Path = InPath;
+	NumFrames = FMath::Max(InNumFrames, 1);
+	FrameIndex = INDEX_NONE;
+	LastFrame = 0;
+	bRunning = true;
+	UE_LOGFMT(LogDrawAllVisualizers, Display, "Capturing {0} frames to {1}", NumFrames, Path);
+}
+
+bool FDrawCapture::BeginView()
+{
+	if (!bRunning) return false;
+
+	if (LastFrame != GFrameCounter)
+	{
+		LastFrame = GFrameCounter;
+		if (++FrameIndex == NumFrames)
+		{
+			Stop();
+			return false;
+		}
+	}
+
+	FCapturedCall& Call = Calls.Add_GetRef({ECapturedCallKind::View});
+	Call.Count = FrameIndex;
+	return true;
+}
+
+void FDrawCapture::AddHUD(int32 NumDrawn)
+{
+	if (!bRunning || LastFrame != GFrameCounter) return;
+
+	FCapturedCall& Call = Calls.Add_GetRef({ECapturedCallKind::HUD});
+	Call.Count = NumDrawn;
+}
+
+void FDrawCapture::Stop()
+{
+	if (!bRunning) return;
+	bRunning = false;
+
+	const FCaptureFileHeader Header = {CaptureFileMagic, CaptureFileVersion, sizeof(FCapturedCall), static_cast<uint32>(FrameIndex + 1),
+	                                   static_cast<uint64>(Calls.Num())};
+
+	const TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Path));
+	if (!Writer.IsValid())
+	{
+		UE_LOGFMT(LogDrawAllVisualizers, Error, "Capture could not be written to {0}", Path);
+		Calls.Empty();
+		return;
+	}
+
+	Writer->Serialize(const_cast<FCaptureFileHeader*>(&Header), sizeof(Header));
+	Writer->Serialize(Calls.GetData(), Calls.Num() * sizeof(FCapturedCall));
+	const bool bWritten = Writer->Close();
+
+	UE_LOGFMT(LogDrawAllVisualizers, Display, "Captured {0} frames and {1} calls to {2}{3}", Header.NumFrames, Calls.Num(), Path,
+	          bWritten ? TEXT("") : TEXT(", write failed"));
+	Calls.Empty();
+}
+
+FCaptureReplay::FCaptureReplay() = default;
+FCaptureReplay::~FCaptureReplay() = default;
+
+bool FCaptureReplay::Open(const FString& Path, FString& OutError)
+{
+	MappedRegion.Reset();
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (!MappedFile.IsValid())
+	{
+		OutError = TEXT("can't open the file");
+		return false;
+	}
+
+	const int64 FileSize = MappedFile->GetFileSize();
+	if (FileSize < static_cast<int64>(sizeof(FCaptureFileHeader)))
+	{
+		OutError = TEXT("file is too small");
+		return false;
+	}
+
+	MappedRegion.Reset(MappedFile->MapRegion(0, FileSize));
+	if (!MappedRegion.IsValid())
+	{
+		OutError = TEXT("can't map the file");
+		return false;
+	}
+
+	const uint8* Data = MappedRegion->GetMappedPtr();
+	const FCaptureFileHeader& Header = *reinterpret_cast<const FCaptureFileHeader*>(Data);
+	if (Header.Magic != CaptureFileMagic || Header.Version != CaptureFileVersion || Header.CallSize != sizeof(FCapturedCall))
+	{
+		OutError = TEXT("not a capture file or captured by another version");
+		return false;
+	}
+	if (FileSize != static_cast<int64>(sizeof(FCaptureFileHeader) + Header.NumCalls * sizeof(FCapturedCall)))
+	{
+		OutError = TEXT("file is truncated");
+		return false;
+	}
+
+	Calls = reinterpret_cast<const FCapturedCall*>(Data + sizeof(FCaptureFileHeader));
+	NumCapturedCalls = Header.NumCalls;
+	NumCapturedFrames = Header.NumFrames;
+
+	Views.Reset();
+	for (int64 CallIndex = 0; CallIndex < NumCapturedCalls; ++CallIndex)
+	{
+		if (Calls[CallIndex].Kind != ECapturedCallKind::View) continue;
+		if (Views.Num() > 0) Views.Last().End = CallIndex;
+		Views.Add({static_cast<int32>(Calls[CallIndex].Count), CallIndex + 1, NumCapturedCalls});
+	}
+	return true;
+}
+
+void FCaptureReplay::ReplayView(const FView& View, FPrimitiveDrawInterface* PDI, FCaptureReplayCounts& OutCounts) const
+{
+	for (int64 CallIndex = View.Begin; CallIndex < View.End; ++CallIndex)
+	{
+		const FCapturedCall& Call = Calls[CallIndex];
+		const bool bScreenSpace = EnumHasAnyFlags(Call.Flags, ECapturedCallFlags::ScreenSpace);
+		switch (Call.Kind)
+		{
+		case ECapturedCallKind::ReserveLines:
+			PDI->AddReserveLines(Call.DepthPriorityGroup, Call.Count, EnumHasAnyFlags(Call.Flags, ECapturedCallFlags::DepthBiased),
+			                     EnumHasAnyFlags(Call.Flags, ECapturedCallFlags::ThickLines));
+			break;
+		case ECapturedCallKind::Line:
+			PDI->DrawLine(FVector(Call.Start), FVector(Call.End), Call.Color, Call.DepthPriorityGroup, Call.Size, Call.DepthBias, bScreenSpace);
+			++OutCounts.Lines;
+			break;
+		case ECapturedCallKind::TranslucentLine:
+			PDI->DrawTranslucentLine(FVector(Call.Start), FVector(Call.End), Call.Color, Call.DepthPriorityGroup, Call.Size, Call.DepthBias, bScreenSpace);
+			++OutCounts.Lines;
+			break;
+		case ECapturedCallKind::Point:
+			PDI->DrawPoint(FVector(Call.Start), Call.Color, Call.Size, Call.DepthPriorityGroup);
+			++OutCounts.Points;
+			break;
+		case ECapturedCallKind::HUD:
+			OutCounts.HUD += Call.Count;
+			break;
+		default:
+			++OutCounts.Skipped;
+			break;
+		}
+	}
+}
+}
@@ -0,0 +1,186 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SceneManagement.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+namespace DrawAllVisualizers
+{
+enum class ECapturedCallKind : uint8
+{
+	// Start of a view drawn by Render. Count is the captured frame index.
+	View,
+	ReserveLines,
+	Line,
+	TranslucentLine,
+	Point,
+
+	// Resources are not captured. These are only counted when replayed.
+	Sprite,
+	Mesh,
+	DynamicResource,
+
+	// FCanvas is not virtual, so DrawHUD can't be recorded call by call. Count is the number of visualizers whose HUD was drawn.
+	HUD,
+};
+
+enum class ECapturedCallFlags : uint8
+{
+	None = 0,
+	ScreenSpace = 1 << 0,
+	DepthBiased = 1 << 1,
+	ThickLines = 1 << 2,
+};
+ENUM_CLASS_FLAGS(ECapturedCallFlags)
+
+// One PDI call. Fixed size so the file can be memory mapped and replayed as is. Positions are floats, plenty for profiling.
+struct FCapturedCall
+{
+	ECapturedCallKind Kind;
+	uint8 DepthPriorityGroup = 0;
+	ECapturedCallFlags Flags = ECapturedCallFlags::None;
+	uint8 Padding = 0;
+	uint32 Count = 0;
+
+	// Thickness, point size or sprite width.
+	float Size = 0.f;
+
+	// Depth bias or sprite height.
+	float DepthBias = 0.f;
+
+	FLinearColor Color = FLinearColor::White;
+	FVector3f Start = FVector3f::ZeroVector;
+	FVector3f End = FVector3f::ZeroVector;
+};
+static_assert(sizeof(FCapturedCall) == 56, "Capture file layout changed, bump CaptureFileVersion");
+
+// Header followed by NumCalls calls, in native byte order.
+struct FCaptureFileHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint32 CallSize;
+	uint32 NumFrames;
+	uint64 NumCalls;
+};
+
+// Passes everything through to the target PDI and appends it to the capture.
+class FCapturingPDI : public FPrimitiveDrawInterface
+{
+public:
+	FCapturingPDI(const FSceneView* InView, FPrimitiveDrawInterface* InTargetPDI, TArray<FCapturedCall>& InCalls);
+
+	virtual bool IsHitTesting() override { return TargetPDI->IsHitTesting(); }
+	virtual void SetHitProxy(HHitProxy* HitProxy) override { TargetPDI->SetHitProxy(HitProxy); }
+	virtual void RegisterDynamicResource(FDynamicPrimitiveResource* DynamicResource) override;
+	virtual void AddReserveLines(uint8 DepthPriorityGroup, int32 NumLines, bool bDepthBiased = false, bool bThickLines = false) override;
+	virtual void DrawSprite(const FVector& Position, float SizeX, float SizeY, const FTexture* Sprite, const FLinearColor& Color, uint8 DepthPriorityGroup,
+	                        float U, float UL, float V, float VL, uint8 BlendMode = 1, float OpacityMaskRefVal = .5f) override;
+	virtual void DrawLine(const FVector& Start, const FVector& End, const FLinearColor& Color, uint8 DepthPriorityGroup,
+	                      float Thickness = 0.0f, float DepthBias = 0.0f, bool bScreenSpace = false) override;
+	virtual void DrawTranslucentLine(const FVector& Start, const FVector& End, const FLinearColor& Color, uint8 DepthPriorityGroup,
+	                                 float Thickness = 0.0f, float DepthBias = 0.0f, bool bScreenSpace = false) override;
+	virtual void DrawPoint(const FVector& Position, const FLinearColor& Color, float PointSize, uint8 DepthPriorityGroup) override;
+	virtual int32 DrawMesh(const FMeshBatch& Mesh) override;
+
+private:
+	FPrimitiveDrawInterface* TargetPDI;
+	TArray<FCapturedCall>& Calls;
+};
+
+// Capture of the next few frames drawn by the EdMode. Kept in memory and written when done.
+class FDrawCapture
+{
+public:
+	void Start(int32 InNumFrames, const FString& InPath);
+
+	// Writes what has been captured so far.
+	void Stop();
+
+	bool IsRunning() const { return bRunning; }
+
+	// Called for each view Render draws. Returns false if not capturing. Starting a view of a new frame after the last one stops the capture.
+	bool BeginView();
+	void AddHUD(int32 NumDrawn);
+
+	TArray<FCapturedCall>& GetCalls() { return Calls; }
+
+private:
+	TArray<FCapturedCall> Calls;
+	FString Path;
+	int32 NumFrames = 0;
+	int32 FrameIndex = INDEX_NONE;
+	uint64 LastFrame = 0;
+	bool bRunning = false;
+};
+
+// Counts of a replayed view.
+struct FCaptureReplayCounts
+{
+	int64 Lines = 0;
+	int64 Points = 0;
+	int64 Skipped = 0;
+	int64 HUD = 0;
+};
+
+// Memory mapped capture file. Nothing is copied, replay reads the calls straight from the mapping.
+class FCaptureReplay
+{
+public:
+	FCaptureReplay();
+	~FCaptureReplay();
+
+	bool Open(const FString& Path, FString& OutError);
+
+	struct FView
+	{
+		int32 Frame;
+		int64 Begin;
+		int64 End;
+	};
+
+	int32 NumFrames() const { return NumCapturedFrames; }
+	int64 NumCalls() const { return NumCapturedCalls; }
+	const TArray<FView>& GetViews() const { return Views; }
+
+	// Draws lines and points of the view to the PDI. Sprites, meshes and HUD are only counted.
+	void ReplayView(const FView& View, FPrimitiveDrawInterface* PDI, FCaptureReplayCounts& OutCounts) const;
+
+private:
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	const FCapturedCall* Calls = nullptr;
+	int64 NumCapturedCalls = 0;
+	int32 NumCapturedFrames = 0;
+	TArray<FView> Views;
+};
+}
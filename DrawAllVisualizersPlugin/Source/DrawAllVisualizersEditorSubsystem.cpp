@@ -28,14 +28,49 @@
 #include "DrawAllVisualizersEditorSubsystem.h"
 #include "Editor.h"
 #include "EditorModeManager.h"
+#include "EngineUtils.h"
 #include "Selection.h"
-#include "Editor/UnrealEdEngine.h"
-#include "UnrealEdGlobals.h"
+#include "ILevelEditor.h"
+#include "LevelEditor.h"
+#include "LevelEditorMenuContext.h"
+#include "LevelEditorViewport.h"
+#include "LevelUtils.h"
+#include "SLevelViewport.h"
+#include "ToolMenus.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/SplineComponent.h"
+#include "Engine/Blueprint.h"
 #include "Kismet2/DebuggerCommands.h"
 #include "Logging/StructuredLog.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "SceneInterface.h"
+#include "SceneManagement.h"
+#include "SceneView.h"
+#include "SplineComponentVisualizer.h"
+#include "Stats/Stats.h"
+#include "WorldPartition/DataLayer/DataLayerInstance.h"
 
 DEFINE_LOG_CATEGORY(LogDrawAllVisualizers)
 
+DECLARE_STATS_GROUP(TEXT("DrawAllVisualizers"), STATGROUP_DrawAllVisualizers, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Rebuild cache"), STAT_DrawAllVisualizers_Rebuild, STATGROUP_DrawAllVisualizers);
+DECLARE_CYCLE_STAT(TEXT("Rebuild selected actors"), STAT_DrawAllVisualizers_RebuildSelectedActors, STATGROUP_DrawAllVisualizers);
+DECLARE_CYCLE_STAT(TEXT("Process world changes"), STAT_DrawAllVisualizers_ProcessWorldChanges, STATGROUP_DrawAllVisualizers);
+DECLARE_CYCLE_STAT(TEXT("Prepare and stale sweep"), STAT_DrawAllVisualizers_Prepare, STATGROUP_DrawAllVisualizers);
+DECLARE_CYCLE_STAT(TEXT("Verify cache"), STAT_DrawAllVisualizers_Verify, STATGROUP_DrawAllVisualizers);
+DECLARE_CYCLE_STAT(TEXT("Render (PDI)"), STAT_DrawAllVisualizers_Render, STATGROUP_DrawAllVisualizers);
+DECLARE_CYCLE_STAT(TEXT("DrawHUD"), STAT_DrawAllVisualizers_DrawHUD, STATGROUP_DrawAllVisualizers);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cached visualizers"), STAT_DrawAllVisualizers_NumCached, STATGROUP_DrawAllVisualizers);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Live visualizers"), STAT_DrawAllVisualizers_NumLive, STATGROUP_DrawAllVisualizers);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cache mismatches (last verify)"), STAT_DrawAllVisualizers_NumMismatches, STATGROUP_DrawAllVisualizers);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Drawn (all views)"), STAT_DrawAllVisualizers_NumDrawn, STATGROUP_DrawAllVisualizers);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Culled (all views)"), STAT_DrawAllVisualizers_NumCulled, STATGROUP_DrawAllVisualizers);
+
+// Per visualizer type scopes. Enable with -trace=cpu,DrawAllVisualizers or from the Insights channel list.
+UE_TRACE_CHANNEL_DEFINE(DrawAllVisualizersChannel)
+
 TAutoConsoleVariable<bool> CVarDrawAllVisualizersEnabled(
 	TEXT("DrawAllVisualizers.Enabled"), false,
 	TEXT("Draw all component visualizers?"),
@@ -46,6 +81,93 @@ TAutoConsoleVariable<bool> CVarDrawAllVisualizersNoCache(
 	TEXT("Skip cache? Try this if cached mode is not working for you for some reason"),
 	ECVF_Default);
 
+TAutoConsoleVariable<float> CVarDrawAllVisualizersRebuildBudgetMs(
+	TEXT("DrawAllVisualizers.RebuildBudgetMs"), 0.f,
+	TEXT("Time per frame used to build the cache, already found visualizers are drawn meanwhile. 0 builds it all in one frame"),
+	ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarDrawAllVisualizersRetained(
+	TEXT("DrawAllVisualizers.Retained"), false,
+	TEXT("Record lines and points of visualizers once and draw the recording until the component changes?"),
+	ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarDrawAllVisualizersParallelScan(
+	TEXT("DrawAllVisualizers.ParallelScan"), true,
+	TEXT("Gather components on worker threads when scanning the whole world. Cache rebuild resolves their visualizers afterwards, NoCache looks them up on the workers too"),
+	ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarDrawAllVisualizersParallelDraw(
+	TEXT("DrawAllVisualizers.ParallelDraw"), false,
+	TEXT("Draw visualizers of Parallel Visualizers classes on worker threads and replay the output on the game thread"),
+	ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarDrawAllVisualizersCoalesce(
+	TEXT("DrawAllVisualizers.Coalesce"), false,
+	TEXT("Gather lines and points of the whole draw pass, merge duplicates and submit them grouped by depth priority, thickness and color"),
+	ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarDrawAllVisualizersSplineFastPath(
+	TEXT("DrawAllVisualizers.SplineFastPath"), true,
+	TEXT("Draw unselected splines from cached adaptive tessellation in one line batch instead of the stock spline visualizer"),
+	ECVF_Default);
+
+TAutoConsoleVariable<float> CVarDrawAllVisualizersVerifyIntervalSeconds(
+	TEXT("DrawAllVisualizers.VerifyIntervalSeconds"), 0.f,
+	TEXT("Compare the cache against a fresh scan this often and report missing, extra and wrongly flagged entries. 0 disables"),
+	ECVF_Default);
+
+TAutoConsoleVariable<float> CVarDrawAllVisualizersVerifyBudgetMs(
+	TEXT("DrawAllVisualizers.VerifyBudgetMs"), 0.5f,
+	TEXT("Time per frame used by the cache verification"),
+	ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarDrawAllVisualizersVerifyRepair(
+	TEXT("DrawAllVisualizers.VerifyRepair"), false,
+	TEXT("Fix the entries the cache verification finds wrong instead of only reporting them"),
+	ECVF_Default);
+
+TAutoConsoleVariable<int32> CVarDrawAllVisualizersHitProxyMode(
+	TEXT("DrawAllVisualizers.HitProxyMode"), 0,
+	TEXT("What is drawn of unselected visualizers when the editor renders hit proxies. 0 full, 1 skip, 2 simplified boxes, 3 full near the cursor only"),
+	ECVF_Default);
+
+TAutoConsoleVariable<float> CVarDrawAllVisualizersDrawBudgetMs(
+	TEXT("DrawAllVisualizers.DrawBudgetMs"), 0.f,
+	TEXT("Time per view used to draw visualizers. Most important ones are drawn first and the rest take turns over next frames. 0 draws everything"),
+	ECVF_Default);
+
+TAutoConsoleVariable<float> CVarDrawAllVisualizersTargetFrameMs(
+	TEXT("DrawAllVisualizers.TargetFrameMs"), 33.3f,
+	TEXT("Draw budget shrinks while editor frame time is over this and grows back when under. 0 keeps the budget fixed"),
+	ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarDrawAllVisualizersCulling(
+	TEXT("DrawAllVisualizers.Culling"), true,
+	TEXT("Skip visualizers that are outside of the view frustum, too far or too small on screen?"),
+	ECVF_Default);
+
+FAutoConsoleCommand DrawAllVisualizersCaptureCommand(
+	TEXT("DrawAllVisualizers.Capture"),
+	TEXT("[Frames=1] [File]. Records PDI calls of the next frames to a file that the benchmark commandlet can replay with -Replay=File. ")
+	TEXT("Default file is in Saved/DrawAllVisualizers"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		using DrawAllVisualizers::FDrawAllVisualizersEdMode;
+		FDrawAllVisualizersEdMode* EdMode = static_cast<FDrawAllVisualizersEdMode*>(
+			GLevelEditorModeTools().GetActiveMode(FDrawAllVisualizersEdMode::EM_DrawAllVisualizers));
+		if (EdMode == nullptr)
+		{
+			UE_LOGFMT(LogDrawAllVisualizers, Error, "DrawAllVisualizers.Capture needs DrawAllVisualizers.Enabled");
+			return;
+		}
+
+		const int32 NumFrames = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1;
+		const FString Path = Args.Num() > 1
+			? Args[1]
+			: FPaths::ProjectSavedDir() / TEXT("DrawAllVisualizers") / FString::Printf(TEXT("Capture-%s.davcapture"), *FDateTime::Now().ToString());
+		EdMode->StartCapture(NumFrames, Path);
+	}));
+
 bool UDrawAllVisualizersEditorSubsystem::ShouldCreateSubsystem(UObject* Outer) const
 {
 	if (IsRunningCommandlet()) return false;
@@ -58,6 +180,9 @@ void UDrawAllVisualizersEditorSubsystem::Deinitialize()
 	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "Subsystem Deinitialize");
 	Super::Deinitialize();
 
+	CVarDrawAllVisualizersEnabled->OnChangedDelegate().Remove(EnabledChangedHandle);
+	UToolMenus::UnRegisterStartupCallback(this);
+	UToolMenus::UnregisterOwner(this);
 	FEditorModeRegistry::Get().UnregisterMode(DrawAllVisualizers::FDrawAllVisualizersEdMode::EM_DrawAllVisualizers);
 	DrawAllVisualizers::FDrawAllVisualizersCommands::Unregister();
 }
@@ -67,16 +192,23 @@ void UDrawAllVisualizersEditorSubsystem::Initialize(FSubsystemCollectionBase& Co
 	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "Subsystem Initialize");
 	Super::Initialize(Collection);
 
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	// Registering is only a factory. Mode instance is created and hooked into everything when it's activated.
 	FEditorModeRegistry::Get().RegisterMode<DrawAllVisualizers::FDrawAllVisualizersEdMode>(
 		DrawAllVisualizers::FDrawAllVisualizersEdMode::EM_DrawAllVisualizers,
 		FText::FromString(TEXT("DrawAllVisualizers")),
 		FSlateIcon(),
 		false);
 
-	GLevelEditorModeTools().ActivateMode(DrawAllVisualizers::FDrawAllVisualizersEdMode::EM_DrawAllVisualizers);
+	// Mode is active only while enabled, so there is nothing called per viewport draw while disabled.
+	EnabledChangedHandle = CVarDrawAllVisualizersEnabled->OnChangedDelegate().AddUObject(this, &UDrawAllVisualizersEditorSubsystem::OnEnabledChanged);
+	UpdateEdModeActivation();
 
 	DrawAllVisualizers::FDrawAllVisualizersCommands::Register();
 
+	UToolMenus::RegisterStartupCallback(FSimpleMulticastDelegate::FDelegate::CreateUObject(this, &UDrawAllVisualizersEditorSubsystem::RegisterViewportMenu));
+
 	FPlayWorldCommands::GlobalPlayWorldActions->MapAction(
 		DrawAllVisualizers::FDrawAllVisualizersCommands::Get().ToggleDrawAllVisualizersEnabledCommand,
 		FExecuteAction::CreateLambda([]()
@@ -89,7 +221,76 @@ void UDrawAllVisualizersEditorSubsystem::Initialize(FSubsystemCollectionBase& Co
 		FCanExecuteAction()
 		);
 
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "Subsystem Initialize took {0} us", (FPlatformTime::Seconds() - StartSeconds) * 1000000.0);
+}
+
+void UDrawAllVisualizersEditorSubsystem::OnEnabledChanged(IConsoleVariable* Variable)
+{
+	UpdateEdModeActivation();
+}
+
+void UDrawAllVisualizersEditorSubsystem::RegisterViewportMenu()
+{
+	FToolMenuOwnerScoped OwnerScoped(this);
+
+	UToolMenu* Menu = UToolMenus::Get()->ExtendMenu("LevelEditor.LevelViewportToolBar.Options");
+	FToolMenuSection& Section = Menu->FindOrAddSection("DrawAllVisualizers", FText::FromString(TEXT("Draw All Visualizers")));
+	Section.AddSubMenu(
+		"DrawAllVisualizersViewportPolicy",
+		FText::FromString(TEXT("Draw All Visualizers")),
+		FText::FromString(TEXT("Where all component visualizers are drawn in this viewport")),
+		FNewToolMenuDelegate::CreateLambda([](UToolMenu* SubMenu)
+		{
+			const ULevelViewportContext* Context = SubMenu->FindContext<ULevelViewportContext>();
+			if (Context == nullptr) return;
+			const TSharedPtr<SLevelViewport> LevelViewport = Context->LevelViewport.Pin();
+			if (!LevelViewport.IsValid()) return;
+
+			const FName ConfigKey = LevelViewport->GetConfigKey();
+			FToolMenuSection& PolicySection = SubMenu->AddSection("Policy");
+
+			const UEnum* PolicyEnum = StaticEnum<EDrawAllVisualizersViewportPolicy>();
+			for (int32 Index = 0; Index < PolicyEnum->NumEnums() - 1; ++Index)
+			{
+				const EDrawAllVisualizersViewportPolicy Policy = static_cast<EDrawAllVisualizersViewportPolicy>(PolicyEnum->GetValueByIndex(Index));
+				PolicySection.AddMenuEntry(
+					PolicyEnum->GetNameByIndex(Index),
+					PolicyEnum->GetDisplayNameTextByIndex(Index),
+					FText::GetEmpty(),
+					FSlateIcon(),
+					FUIAction(
+						FExecuteAction::CreateLambda([ConfigKey, Policy]()
+						{
+							GetMutableDefault<UDrawAllVisualizersViewportSettings>()->SetPolicy(ConfigKey, Policy);
+							GEditor->RedrawAllViewports(false);
+						}),
+						FCanExecuteAction(),
+						FIsActionChecked::CreateLambda([ConfigKey, Policy]()
+						{
+							return GetDefault<UDrawAllVisualizersViewportSettings>()->GetPolicy(ConfigKey) == Policy;
+						})),
+					EUserInterfaceActionType::RadioButton);
+			}
+		}));
+}
+
+void UDrawAllVisualizersEditorSubsystem::UpdateEdModeActivation()
+{
+	const FEditorModeID ModeID = DrawAllVisualizers::FDrawAllVisualizersEdMode::EM_DrawAllVisualizers;
+	const bool bEnabled = CVarDrawAllVisualizersEnabled.GetValueOnGameThread();
+	if (bEnabled == GLevelEditorModeTools().IsModeActive(ModeID)) return;
 
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "UpdateEdModeActivation enabled {0}", bEnabled);
+	if (bEnabled)
+	{
+		GLevelEditorModeTools().ActivateMode(ModeID);
+	}
+	else
+	{
+		// Exit unhooks everything and releases the cache.
+		GLevelEditorModeTools().DeactivateMode(ModeID);
+	}
+	GEditor->RedrawAllViewports(false);
 }
 
 void UDrawAllVisualizersSettings::PostInitProperties()
@@ -105,10 +306,30 @@ void UDrawAllVisualizersSettings::PostInitProperties()
 
 		CVarDrawAllVisualizersEnabled->Set(bEnabled, ECVF_SetByProjectSetting);
 		CVarDrawAllVisualizersNoCache->Set(bNoCache, ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersCulling->Set(bCulling, ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersRetained->Set(bRetained, ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersRebuildBudgetMs->Set(RebuildBudgetMs, ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersParallelScan->Set(bParallelScan, ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersParallelDraw->Set(bParallelDraw, ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersCoalesce->Set(bCoalesce, ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersSplineFastPath->Set(bSplineFastPath, ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersHitProxyMode->Set(static_cast<int32>(HitProxyMode), ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersDrawBudgetMs->Set(DrawBudgetMs, ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersTargetFrameMs->Set(TargetFrameMs, ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersVerifyIntervalSeconds->Set(VerifyIntervalSeconds, ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersVerifyBudgetMs->Set(VerifyBudgetMs, ECVF_SetByProjectSetting);
+		CVarDrawAllVisualizersVerifyRepair->Set(bVerifyRepair, ECVF_SetByProjectSetting);
 	}
 #endif
 }
 
+void UDrawAllVisualizersViewportSettings::SetPolicy(FName ConfigKey, EDrawAllVisualizersViewportPolicy Policy)
+{
+	if (Policy == EDrawAllVisualizersViewportPolicy::Enabled) ViewportPolicies.Remove(ConfigKey);
+	else ViewportPolicies.Add(ConfigKey, Policy);
+	SaveConfig();
+}
+
 FName UDrawAllVisualizersSettings::GetCategoryName() const
 {
 	return FName(TEXT("Editor"));
@@ -145,51 +366,242 @@ void FDrawAllVisualizersCommands::RegisterCommands()
 #undef LOCTEXT_NAMESPACE
 }
 
-template <typename Func>
-void ForeachActorComponentVisualizer(Func F)
+FVisualizerCullParams ResolveCullParams(const UClass* Class, const UDrawAllVisualizersSettings* Settings)
 {
-	// Could perhaps just use TObjectIterator<UActorComponent>, but this deeper level route is better for learning.
-
-	bool IsPlaying = GEditor->IsPlayingSessionInEditor();
-	TInlineComponentArray<UActorComponent*> Components;
+	const FDrawAllVisualizersCullingSettings* CullingSettings = &Settings->Culling;
 
-	const auto& Worlds = GEditor->GetWorldContexts();
-	for (const auto& WorldContext : Worlds)
+	// Closest class in the hierarchy with an override wins. Resolved once per cached entry, not per frame.
+	for (const UClass* It = Class; It != nullptr; It = It->GetSuperClass())
 	{
-		const UWorld* World = WorldContext.World();
-		if (World == nullptr || World->WorldType == EWorldType::EditorPreview) continue;
-
-		if (IsPlaying)
+		if (const FDrawAllVisualizersCullingSettings* Override = Settings->ClassCulling.Find(It->GetFName()))
 		{
-			if (World->WorldType != EWorldType::Game & World->WorldType != EWorldType::PIE) continue;
+			CullingSettings = Override;
+			break;
 		}
+	}
 
-		for (const ULevel* Level : World->GetLevels())
-		{
-			if (!IsValid(Level)) continue;
+	FVisualizerCullParams Params;
+	Params.MaxDrawDistance = CullingSettings->MaxDrawDistance;
+	Params.MinScreenSize = CullingSettings->MinScreenSize;
+	Params.bFrustumCulling = !CullingSettings->bSkipFrustumCulling;
+	return Params;
+}
 
-			for (auto Actor : Level->Actors)
-			{
-				if (!IsValid(Actor)) continue;
+bool IsRetainable(const UClass* Class, const UDrawAllVisualizersSettings* Settings)
+{
+	for (const UClass* It = Class; It != nullptr; It = It->GetSuperClass())
+	{
+		if (Settings->ImmediateModeVisualizers.Contains(It->GetFName())) return false;
+	}
+	return true;
+}
 
-				Components.Reset();
-				Actor->GetComponents(Components, false);
+bool IsParallelDrawable(const UClass* Class, const UDrawAllVisualizersSettings* Settings)
+{
+	for (const UClass* It = Class; It != nullptr; It = It->GetSuperClass())
+	{
+		if (Settings->ParallelVisualizers.Contains(It->GetFName())) return true;
+	}
+	return false;
+}
 
-				for (auto Component : Components)
-				{
-					// Editor does this. This does not.
-					// if (!Comp->IsRegistered()) continue;
+// Only the visualizer registered for USplineComponent is known to draw what FSplineRenderer draws. Subclasses with their own visualizer keep it.
+bool IsSplineFastPathVisualizer(const UClass* Class, const TSharedPtr<FComponentVisualizer>& Visualizer)
+{
+	return Class->IsChildOf<USplineComponent>() && Visualizer == GUnrealEd->FindComponentVisualizer(USplineComponent::StaticClass());
+}
+
+const USplineComponent* FindEditedSplineComponent()
+{
+	const TSharedPtr<FComponentVisualizer> SplineVisualizer = GUnrealEd->FindComponentVisualizer(USplineComponent::StaticClass());
+	return SplineVisualizer.IsValid() ? static_cast<FSplineComponentVisualizer*>(SplineVisualizer.Get())->GetEditedSplineComponent() : nullptr;
+}
 
-					TSharedPtr<FComponentVisualizer> Visualizer = GUnrealEd->FindComponentVisualizer(Component->GetClass());
-					if (!Visualizer.IsValid()) continue;
+// Live entries per parallel draw task. Big enough that splines with few points are not all task overhead.
+constexpr int32 VisualizersPerParallelChunk = 64;
 
-					F(Actor.Get(), Component, Visualizer);
-				}
+// Views without a family or scene have no world to draw.
+const UWorld* GetViewWorld(const FSceneView* View)
+{
+	const FSceneInterface* Scene = View->Family != nullptr ? View->Family->Scene : nullptr;
+	return Scene != nullptr ? Scene->GetWorld() : nullptr;
+}
+
+// Non scene components use the bounds of the owning actor root.
+const USceneComponent* GetBoundsComponent(const UActorComponent* Component)
+{
+	const USceneComponent* SceneComponent = Cast<USceneComponent>(Component);
+	if (SceneComponent != nullptr) return SceneComponent;
+
+	const AActor* Owner = Component->GetOwner();
+	return Owner != nullptr ? Owner->GetRootComponent() : nullptr;
+}
+
+bool IsCulled(const UActorComponent* Component, const FVisualizerCullParams& Params, const FSceneView* View, float MinScreenSizeFloor = 0.f)
+{
+	// Without bounds there is nothing to test against.
+	const USceneComponent* SceneComponent = GetBoundsComponent(Component);
+	if (SceneComponent == nullptr) return false;
+
+	const FBoxSphereBounds& Bounds = SceneComponent->Bounds;
+
+	if (Params.MaxDrawDistance > 0.f)
+	{
+		// Distance to the bounding sphere surface rather than to the origin so large components don't pop out too early.
+		const double DistanceSquared = FVector::DistSquared(Bounds.Origin, View->ViewMatrices.GetViewOrigin());
+		if (DistanceSquared > FMath::Square(Params.MaxDrawDistance + Bounds.SphereRadius)) return true;
+	}
+
+	// Only primitives have bounds that cover what they draw. Lights, audio and cameras report a point at their origin
+	// while their visualizers span the attenuation radius or frustum, so those are only distance culled.
+	FBoxSphereBounds CullBounds = Bounds;
+	if (!SceneComponent->IsA<UPrimitiveComponent>() || Bounds.BoxExtent.IsNearlyZero())
+	{
+		if (SceneComponent == Component) return false;
+
+		// Non scene component on an actor whose root renders nothing, like spline and target point Blueprints. Bounds of what the actor renders instead.
+		const FBox ActorBox = Component->GetOwner()->GetComponentsBoundingBox(true);
+		if (!ActorBox.IsValid) return false;
+		CullBounds = FBoxSphereBounds(ActorBox);
+	}
+
+	if (Params.bFrustumCulling && !View->ViewFrustum.IntersectBox(CullBounds.Origin, CullBounds.BoxExtent)) return true;
+
+	const float MinScreenSize = FMath::Max(Params.MinScreenSize, MinScreenSizeFloor);
+	if (MinScreenSize > 0.f && ComputeBoundsScreenSize(CullBounds.Origin, CullBounds.SphereRadius, *View) < MinScreenSize) return true;
+
+	return false;
+}
+
+// Box lines are hard to hit when they are thin.
+constexpr float SimplifiedHitProxyThickness = 3.f;
+
+// Clicking the box selects the actor, after which the editor draws its visualizers with their own hit proxies.
+void DrawSimplifiedHitProxy(const UActorComponent* Component, FPrimitiveDrawInterface* PDI)
+{
+	const USceneComponent* SceneComponent = GetBoundsComponent(Component);
+	AActor* Owner = Component->GetOwner();
+	if (SceneComponent == nullptr || Owner == nullptr) return;
+
+	// World depth group, so the boxes of big volumes don't cover everything inside them.
+	PDI->SetHitProxy(new HActor(Owner, Cast<UPrimitiveComponent>(Component)));
+	DrawWireBox(PDI, SceneComponent->Bounds.GetBox(), FColor::White, SDPG_World, SimplifiedHitProxyThickness);
+	PDI->SetHitProxy(nullptr);
+}
+
+bool IsNearCursor(const UActorComponent* Component, const FSceneView* View, const FIntPoint& Cursor, float RadiusPixels)
+{
+	const USceneComponent* SceneComponent = GetBoundsComponent(Component);
+	if (SceneComponent == nullptr) return true;
+
+	const FBoxSphereBounds& Bounds = SceneComponent->Bounds;
+	FVector2D Pixel;
+	if (!View->WorldToPixel(Bounds.Origin, Pixel))
+	{
+		// Behind the camera. Could still be under the cursor if the camera is inside the bounds.
+		return FVector::DistSquared(Bounds.Origin, View->ViewMatrices.GetViewOrigin()) < FMath::Square(Bounds.SphereRadius);
+	}
+
+	const float BoundsRadiusPixels = ComputeBoundsScreenSize(Bounds.Origin, Bounds.SphereRadius, *View) * 0.5f * View->UnscaledViewRect.Width();
+	return FVector2D::DistSquared(Pixel, FVector2D(Cursor)) <= FMath::Square(RadiusPixels + BoundsRadiusPixels);
+}
+
+// Bigger on screen first. Anything around the selection is what the user is working on, so it goes before the rest.
+float GetDrawPriority(const UActorComponent* Component, const FSceneView* View, const FBox& SelectionNeighbourhood)
+{
+	const USceneComponent* SceneComponent = GetBoundsComponent(Component);
+	if (SceneComponent == nullptr) return 0.f;
+
+	const FBoxSphereBounds& Bounds = SceneComponent->Bounds;
+	float Priority = ComputeBoundsScreenSize(Bounds.Origin, Bounds.SphereRadius, *View);
+	if (SelectionNeighbourhood.IsValid && SelectionNeighbourhood.IsInsideOrOn(Bounds.Origin)) Priority += 1.f;
+	return Priority;
+}
+
+// Everything that hides the component in the editor viewport. Visualizers of hidden components are not drawn either.
+ECachedVisualizerFlags ComputeHiddenFlags(const UActorComponent* Component)
+{
+	ECachedVisualizerFlags Flags = ECachedVisualizerFlags::None;
+
+	const USceneComponent* SceneComponent = Cast<USceneComponent>(Component);
+	if (SceneComponent != nullptr && !SceneComponent->IsVisible()) Flags |= ECachedVisualizerFlags::HiddenComponent;
+
+	const AActor* Actor = Component->GetOwner();
+	if (Actor == nullptr) return Flags;
+
+	if (Actor->IsTemporarilyHiddenInEditor()) Flags |= ECachedVisualizerFlags::HiddenTemporarily;
+	if (Actor->bHiddenEdLayer) Flags |= ECachedVisualizerFlags::HiddenLayer;
+	if (Actor->bHiddenEdLevel) Flags |= ECachedVisualizerFlags::HiddenLevel;
+
+	const ULevel* Level = Actor->GetLevel();
+	if (Level != nullptr)
+	{
+		// Streaming levels and World Partition cells that are still being made visible, or are on their way out.
+		// Destroyed actors and actors unloaded in the editor are removed from the cache instead.
+		if (!FLevelUtils::IsLevelVisible(Level)) Flags |= ECachedVisualizerFlags::HiddenLevel;
+		if (Level->bIsBeingRemoved) Flags |= ECachedVisualizerFlags::Unloaded;
+	}
+
+	// Data layer visibility is an editor thing. In PIE hidden data layers are not loaded at all.
+	const UWorld* World = Actor->GetWorld();
+	if (World != nullptr && World->WorldType == EWorldType::Editor)
+	{
+		for (const UDataLayerInstance* DataLayer : Actor->GetDataLayerInstances())
+		{
+			if (DataLayer != nullptr && !DataLayer->IsEffectiveVisible())
+			{
+				Flags |= ECachedVisualizerFlags::HiddenDataLayer;
+				break;
 			}
 		}
 	}
+
+	return Flags;
+}
+
+// Config key of the level viewport slot showing the client. Asked from the level editor, so only its own viewports match.
+FName FindViewportConfigKey(const FViewportClient* ViewportClient)
+{
+	FLevelEditorModule* LevelEditorModule = FModuleManager::GetModulePtr<FLevelEditorModule>("LevelEditor");
+	const TSharedPtr<ILevelEditor> LevelEditor = LevelEditorModule != nullptr ? LevelEditorModule->GetFirstLevelEditor() : nullptr;
+	if (!LevelEditor.IsValid()) return NAME_None;
+
+	for (const TSharedPtr<SLevelViewport>& LevelViewport : LevelEditor->GetViewports())
+	{
+		if (LevelViewport.IsValid() && &LevelViewport->GetLevelViewportClient() == ViewportClient) return LevelViewport->GetConfigKey();
+	}
+	return NAME_None;
+}
+
+bool IsExcludedByPolicy(EDrawAllVisualizersViewportPolicy Policy, const FSceneView* View)
+{
+	switch (Policy)
+	{
+	case EDrawAllVisualizersViewportPolicy::Disabled: return true;
+	case EDrawAllVisualizersViewportPolicy::PerspectiveOnly: return !View->IsPerspectiveProjection();
+	case EDrawAllVisualizersViewportPolicy::OrthographicOnly: return View->IsPerspectiveProjection();
+	default: return false;
+	}
+}
+
+bool IsReducedDetailByPolicy(EDrawAllVisualizersViewportPolicy Policy, const FSceneView* View)
+{
+	return Policy == EDrawAllVisualizersViewportPolicy::ReducedOrthographic && !View->IsPerspectiveProjection();
 }
 
+// Screen size under which visualizers are skipped in reduced detail views.
+constexpr float ReducedDetailMinScreenSize = 0.02f;
+
+// How far around the selected actors counts as their neighbourhood.
+constexpr double SelectionNeighbourhoodRadius = 5000.0;
+
+// Deferred entries gain this much priority every frame they wait. Screen size is at most about 1 and the selection adds 1,
+// so anything that has waited 40 frames goes before everything that was drawn last frame. Makes the entries over budget take turns.
+constexpr float DeferredPriorityPerFrame = 0.05f;
+
+// Aging state of views that haven't drawn for this many frames is dropped.
+constexpr uint64 DrawBudgetViewStateFrames = 600;
+
 const FEditorModeID FDrawAllVisualizersEdMode::EM_DrawAllVisualizers("EM_DrawAllVisualizers");
 
 FDrawAllVisualizersEdMode::FDrawAllVisualizersEdMode()
@@ -200,60 +612,112 @@ FDrawAllVisualizersEdMode::FDrawAllVisualizersEdMode()
 FDrawAllVisualizersEdMode::~FDrawAllVisualizersEdMode()
 {
 	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "~FDrawAllVisualizersEdMode()");
+	UnbindDelegates();
+}
+
+void FDrawAllVisualizersEdMode::Initialize()
+{
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "FDrawAllVisualizersEdMode Initialize");
+	FEdMode::Initialize();
+
+	// Delegates are bound on Enter. Deactivated mode instance is kept around by the mode manager and reused.
+}
 
+void FDrawAllVisualizersEdMode::UnbindDelegates()
+{
 	USelection::SelectionChangedEvent.RemoveAll(this);
+	FEditorDelegates::PreBeginPIE.RemoveAll(this);
 	FEditorDelegates::PostPIEStarted.RemoveAll(this);
+	FEditorDelegates::PrePIEEnded.RemoveAll(this);
 	FEditorDelegates::EndPIE.RemoveAll(this);
+	FEditorDelegates::CancelPIE.RemoveAll(this);
+
+	FEditorDelegates::PostUndoRedo.RemoveAll(this);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.RemoveAll(this);
+	FModuleManager::Get().OnModulesChanged().RemoveAll(this);
+	FCoreUObjectDelegates::OnObjectsReinstanced.RemoveAll(this);
+	FCoreUObjectDelegates::GetPostGarbageCollect().RemoveAll(this);
+
+	if (GEditor != nullptr)
+	{
+		GEditor->OnBlueprintPreCompile().RemoveAll(this);
+		GEditor->OnBlueprintCompiled().RemoveAll(this);
+		GEditor->OnLevelViewportClientListChanged().RemoveAll(this);
+	}
 
-	if (OnObjectConstructedHandle.IsValid())
+	if (UObjectInitialized())
 	{
-		FCoreUObjectDelegates::OnObjectConstructed.Remove(OnObjectConstructedHandle);
-		OnObjectConstructedHandle.Reset();
+		GetMutableDefault<UDrawAllVisualizersSettings>()->OnSettingChanged().RemoveAll(this);
 	}
+
+	StopTrackingWorldChanges();
 }
 
-void FDrawAllVisualizersEdMode::Initialize()
+void FDrawAllVisualizersEdMode::BindDelegates()
 {
-	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "FDrawAllVisualizersEdMode Initialize");
-	FEdMode::Initialize();
-
 	USelection::SelectionChangedEvent.AddSP(this, &FDrawAllVisualizersEdMode::OnSelectionChanged);
+	FEditorDelegates::PreBeginPIE.AddSP(this, &FDrawAllVisualizersEdMode::OnPrePieTransition);
 	FEditorDelegates::PostPIEStarted.AddSP(this, &FDrawAllVisualizersEdMode::OnPieStartOrEnd);
+	FEditorDelegates::PrePIEEnded.AddSP(this, &FDrawAllVisualizersEdMode::OnPrePieTransition);
 	FEditorDelegates::EndPIE.AddSP(this, &FDrawAllVisualizersEdMode::OnPieStartOrEnd);
+	FEditorDelegates::CancelPIE.AddSP(this, &FDrawAllVisualizersEdMode::OnCancelPie);
+	GetMutableDefault<UDrawAllVisualizersSettings>()->OnSettingChanged().AddSP(this, &FDrawAllVisualizersEdMode::OnSettingsChanged);
+
+	// For retained mode. Cheap early outs when it's not used.
+	FEditorDelegates::PostUndoRedo.AddSP(this, &FDrawAllVisualizersEdMode::OnPostUndoRedo);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.AddSP(this, &FDrawAllVisualizersEdMode::OnObjectPropertyChanged);
+
+	// Invalidation of class to visualizer resolutions.
+	FModuleManager::Get().OnModulesChanged().AddSP(this, &FDrawAllVisualizersEdMode::OnModulesChanged);
+	FCoreUObjectDelegates::OnObjectsReinstanced.AddSP(this, &FDrawAllVisualizersEdMode::OnObjectsReinstanced);
+	FCoreUObjectDelegates::GetPostGarbageCollect().AddSP(this, &FDrawAllVisualizersEdMode::OnPostGarbageCollect);
+	GEditor->OnBlueprintPreCompile().AddSP(this, &FDrawAllVisualizersEdMode::OnBlueprintPreCompile);
+	GEditor->OnBlueprintCompiled().AddSP(this, &FDrawAllVisualizersEdMode::OnBlueprintCompiled);
+	GEditor->OnLevelViewportClientListChanged().AddSP(this, &FDrawAllVisualizersEdMode::OnLevelViewportClientListChanged);
 
-	// Not hooking into FCoreUObjectDelegates::OnObjectConstructed yet. It's kinda high frequency event so don't use it until needed.
+	// Map loads need nothing here. They deactivate all modes, so Exit() and Enter() already do the single rebuild.
+
+	// Not tracking world changes yet. Those are only needed once there is a cache to keep up to date.
 }
 
 void FDrawAllVisualizersEdMode::Enter()
 {
 	// FEdMode::Enter();	// Don't need this.
 	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "FDrawAllVisualizersEdMode Enter");
-	bNeedActivateEdMode = false;
+
+	// Selection and everything else may have changed while not active.
+	bIngestionSuspended = false;
+	BindDelegates();
+	CompileFilter();
+	bNeedRebuildCachedVisualizers = true;
+	bNeedRebuildSelectedActors = true;
 }
 
 void FDrawAllVisualizersEdMode::Exit()
 {
 	// FEdMode::Exit();		// Don't need this.
 
-	// Register mode again on next Tick when it gets disabled.
+	// Register mode again on next Tick when it gets deactivated while still enabled.
 	// Main causes of this is FEditorModeTools::DeactivateAllModes(), which happens from map loads.
+	// Disabling deactivates the mode too, that one is not activated again.
 
-	// Previous way was to hook into OnMapOpen and do this:
-	// if (ChangeType == EMapChangeType::TearDownWorld) bNeedActivateEdMode = true;
-	// else if(bNeedActivateEdMode) GLevelEditorModeTools().ActivateMode(EM_DrawAllVisualizers);
-	//
-	// Previous way however had few issues:
-	//	- Must hook into FLevelEditorModule::OnLevelEditorCreated() to delay activating the mode because
-	//		on the first Tick FEditorModeTools::ExitAllModesPendingDeactivate() is called. Didn't check what puts it to pending deactivate list.
-	//		- ExitAllModesPendingDeactivate also does "check(PendingDeactivateModes.Num() == 0);" so can't really work around it.
-	//	- Would not survive any calls to DeactivateAllModes().
+	UnbindDelegates();
+	CancelRebuildCachedVisualizers();
+	CachedVisualizers.Empty();
+	NoCacheCullParams.Empty();
+	ViewportConfigKeys.Empty();
+	DrawBudgetViewStates.Empty();
+	SplineRenderer.Empty();
+	Capture.Stop();
 
 	bool bExitRequested = IsEngineExitRequested();
 	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "FDrawAllVisualizersEdMode Exit IsEngineExitRequested {0}", bExitRequested);
-	if (!bExitRequested)
+	if (!bExitRequested && CVarDrawAllVisualizersEnabled.GetValueOnGameThread())
 	{
 		GEditor->GetTimerManager()->SetTimerForNextTick([]
 		{
+			// Could have been disabled or activated again meanwhile.
+			if (!CVarDrawAllVisualizersEnabled.GetValueOnGameThread() || GLevelEditorModeTools().IsModeActive(EM_DrawAllVisualizers)) return;
 			GLevelEditorModeTools().ActivateMode(EM_DrawAllVisualizers);
 		});
 	}
@@ -274,83 +738,161 @@ void FDrawAllVisualizersEdMode::Render(const FSceneView* View, FViewport* Viewpo
 {
 	// FEdMode::Render(View, Viewport, PDI);	// Don't need this.
 
-	const bool bEnabledNew = CVarDrawAllVisualizersEnabled.GetValueOnGameThread();
-	if (bEnabledNew != bEnabled)
+	SCOPE_CYCLE_COUNTER(STAT_DrawAllVisualizers_Render);
+
+	// Before anything else, excluded viewports cost only this.
+	const EDrawAllVisualizersViewportPolicy ViewportPolicy = FindViewportPolicy(Viewport != nullptr ? Viewport->GetClient() : nullptr);
+	if (IsExcludedByPolicy(ViewportPolicy, View)) return;
+
+	const UDrawAllVisualizersSettings* Settings = GetDefault<UDrawAllVisualizersSettings>();
+
+	bNoCache = CVarDrawAllVisualizersNoCache.GetValueOnGameThread();
+	bCulling = CVarDrawAllVisualizersCulling.GetValueOnGameThread();
+
+	const bool bReducedDetail = IsReducedDetailByPolicy(ViewportPolicy, View);
+	bCullView = bCulling || bReducedDetail;
+	ViewMinScreenSize = bReducedDetail ? ReducedDetailMinScreenSize : 0.f;
+	bParallelScan = CVarDrawAllVisualizersParallelScan.GetValueOnGameThread();
+	bParallelDraw = CVarDrawAllVisualizersParallelDraw.GetValueOnGameThread();
+	bSplineFastPath = CVarDrawAllVisualizersSplineFastPath.GetValueOnGameThread() && !PDI->IsHitTesting();
+
+	HitProxyMode = EDrawAllVisualizersHitProxyMode::Full;
+	if (PDI->IsHitTesting())
 	{
-		bEnabled = bEnabledNew;
-		if (!bEnabledNew)
+		HitProxyMode = static_cast<EDrawAllVisualizersHitProxyMode>(FMath::Clamp(CVarDrawAllVisualizersHitProxyMode.GetValueOnGameThread(), 0,
+			static_cast<int32>(EDrawAllVisualizersHitProxyMode::NearCursor)));
+
+		// Benchmark has no viewport and no cursor.
+		if (HitProxyMode == EDrawAllVisualizersHitProxyMode::NearCursor && Viewport == nullptr) HitProxyMode = EDrawAllVisualizersHitProxyMode::Full;
+		if (HitProxyMode == EDrawAllVisualizersHitProxyMode::NearCursor)
 		{
-			CachedVisualizers.Empty();
-			if (OnObjectConstructedHandle.IsValid())
-			{
-				FCoreUObjectDelegates::OnObjectConstructed.Remove(OnObjectConstructedHandle);
-				OnObjectConstructedHandle.Reset();
-			}
+			HitProxyViewport = Viewport;
+			HitProxyCursor = FIntPoint(Viewport->GetMouseX(), Viewport->GetMouseY());
+			HitProxyCursorRadius = Settings->HitProxyCursorRadius;
 		}
-		bNeedRebuildCachedVisualizers = true;
-		GEditor->RedrawAllViewports(false);
 	}
 
-	if (!bEnabledNew) return;
+	const bool bRetainedNew = CVarDrawAllVisualizersRetained.GetValueOnGameThread();
+	if (bRetainedNew != bRetained)
+	{
+		bRetained = bRetainedNew;
+		CachedVisualizers.EmptyGeometries();
+	}
 
-	const UDrawAllVisualizersSettings* Settings = GetDefault<UDrawAllVisualizersSettings>();
+	// Hit proxies can't be recorded.
+	const bool bDrawRetained = bRetained && !PDI->IsHitTesting();
+
+	NumDrawnLastView = 0;
+	NumCulledLastView = 0;
+	NumDeferredLastView = 0;
+
+	// Editor renders hit proxies on clicks and on mouse hover. Without this all visualizers would be drawn again each time.
+	if (HitProxyMode == EDrawAllVisualizersHitProxyMode::Skip)
+	{
+		DrawEditedSplineHitProxies(View, PDI);
+		return;
+	}
+
+	// Everything below draws through this when coalescing. Flushed to the real PDI at the end of the pass.
+	TOptional<FCoalescingPDI> CoalescingPDI;
+	if (CVarDrawAllVisualizersCoalesce.GetValueOnGameThread() && !PDI->IsHitTesting())
+	{
+		CoalescedCountsLastView = FCoalescedCounts();
+		CoalescingPDI.Emplace(View, PDI, CoalescedGeometry);
+		PDI = CoalescingPDI.GetPtrOrNull();
+	}
+
+	// Records what Render issues, before coalescing. Keeps viewports redrawing until enough frames are captured.
+	TOptional<FCapturingPDI> CapturingPDI;
+	if (!PDI->IsHitTesting() && Capture.BeginView())
+	{
+		CapturingPDI.Emplace(View, PDI, Capture.GetCalls());
+		PDI = CapturingPDI.GetPtrOrNull();
+		GEditor->RedrawAllViewports(false);
+	}
+
+	EditedSplineComponent = FindEditedSplineComponent();
 
-	bNoCache = CVarDrawAllVisualizersNoCache.GetValueOnGameThread();
 	if (bNoCache)
 	{
+		CancelRebuildCachedVisualizers();
+		StopTrackingWorldChanges();
 		CachedVisualizers.Empty();
 		bNeedRebuildCachedVisualizers = true;
 		if (bNeedRebuildSelectedActors) RebuildSelectedActors();
 
-		ForeachActorComponentVisualizer([&](AActor* Actor, const UActorComponent* Component, const TSharedPtr<FComponentVisualizer>& Visualizer)
+		ScannedVisualizers.Reset();
+		GatherActorComponentVisualizers(ScannedVisualizers, bParallelScan);
+
+		const UWorld* ViewWorld = GetViewWorld(View);
+		for (const FScannedVisualizer& Scanned : ScannedVisualizers)
 		{
-			if (SelectedActors.Contains(Actor)) return;
-			if (Settings->IgnoredVisualizers.Contains(Component->GetClass()->GetFName())) return;
-			Visualizer->DrawVisualization(Component, View, PDI);
-		});
+			const UActorComponent* Component = Scanned.Component;
+			if (Component->GetWorld() != ViewWorld) continue;
+			if (SelectedActors.Contains(Scanned.Actor)) continue;
+			if (!PassesFilter(Scanned.Actor, Component)) continue;
+			if (ComputeHiddenFlags(Component) != ECachedVisualizerFlags::None) continue;
+			if (bCullView && IsCulled(Component, FindNoCacheCullParams(Component->GetClass()), View, ViewMinScreenSize))
+			{
+				++NumCulledLastView;
+				continue;
+			}
+			++NumDrawnLastView;
+			if (DrawHitProxyInstead(Component, View, PDI)) continue;
+			Scanned.Visualizer->DrawVisualization(Component, View, PDI);
+		}
+
+		if (CoalescingPDI.IsSet()) CoalescingPDI->Flush(CoalescedCountsLastView);
 		return;
 	}
 
-	if (bNeedRebuildCachedVisualizers) RebuildCachedVisualizers();
+	const int32 NumRegisteredVisualizersNew = GUnrealEd->ComponentVisualizerMap.Num();
+	if (NumRegisteredVisualizersNew != NumRegisteredVisualizers)
+	{
+		// Cached entries hold on to the visualizers, so unregistered ones would still be drawn without a full rebuild.
+		NumRegisteredVisualizers = NumRegisteredVisualizersNew;
+		bNeedRebuildCachedVisualizers = true;
+	}
 
+	// Selection first so rebuild can flag selected entries right away.
 	if (bNeedRebuildSelectedActors) RebuildSelectedActors();
 
+	// Last rebuilt cache is drawn as is while a bulk operation is in progress.
+	if (!bIngestionSuspended)
+	{
+		if (bNeedRebuildCachedVisualizers) RebuildCachedVisualizers();
+		else if (RebuildScan.IsRunning()) StepRebuildCachedVisualizers();
+	}
+
+	ProcessPendingWorldChanges();
+	StepVerifyCache();
+	PrepareLiveVisualizers();
+
+	if (bSplineFastPath) SplineRenderer.Prune(GFrameCounter);
+
 	// Editor does check like this. This does not.
 	// if (GCurrentLevelEditingViewportClient != nullptr && GCurrentLevelEditingViewportClient->IsInGameView()) return;
 
-	// Collect stale entries and remove later. Don't know and don't care if current container allows removal during iteration.
-	// Safer for possible container changes in the future this way.
-	TInlineComponentArray<TWeakObjectPtr<UActorComponent>> StaleEntries;
-
-	for (const auto& Tuple : CachedVisualizers)
+	if (const TArray<FLiveVisualizer>* LiveVisualizers = FindLiveVisualizers(View))
 	{
-		const FCachedVisualizer& CachedVisualizer = Tuple.Value;
-		const UActorComponent* Component = Tuple.Key.Get();
-		if (Component == nullptr)
+		if (CVarDrawAllVisualizersDrawBudgetMs.GetValueOnGameThread() > 0.f)
 		{
-			// Also happens when modifying the actor or components.
-			// Like when moving with the transform gizmo or editing values from details panel.
-			// New component created this way is caught by OnObjectConstructed.
-
-			StaleEntries.Add(Tuple.Key);
-			continue;
+			// Deferred entries take their turn on the following frames, which viewports that are not realtime would never draw.
+			// Only this viewport is redrawn and only until everything has had its turn once.
+			if (DrawLiveVisualizersWithBudget(*LiveVisualizers, View, PDI, bDrawRetained)) Viewport->Invalidate();
 		}
+		else
+		{
+			DrawLiveVisualizers(*LiveVisualizers, View, PDI, bDrawRetained);
+		}
+	}
 
-		if (CachedVisualizer.IsSelected) continue;
-
-		UWorld* World = Component->GetWorld();
-		if (World == nullptr || World->WorldType == EWorldType::EditorPreview) continue;
-
-		// Editor does this. This does not.
-		// if (!Component->IsRegistered()) continue;
+	SplineRenderer.Flush(PDI);
 
-		CachedVisualizer.Visualizer->DrawVisualization(Component, View, PDI);
-	}
+	if (CoalescingPDI.IsSet()) CoalescingPDI->Flush(CoalescedCountsLastView);
 
-	for (auto Elem : StaleEntries)
-	{
-		CachedVisualizers.Remove(Elem);
-	}
+	INC_DWORD_STAT_BY(STAT_DrawAllVisualizers_NumDrawn, NumDrawnLastView);
+	INC_DWORD_STAT_BY(STAT_DrawAllVisualizers_NumCulled, NumCulledLastView);
 
 	if (Settings->bDisplayVisualizerTypeCountsOnScreen)
 	{
@@ -358,155 +900,1347 @@ void FDrawAllVisualizersEdMode::Render(const FSceneView* View, FViewport* Viewpo
 	}
 }
 
-void FDrawAllVisualizersEdMode::DrawHUD(FEditorViewportClient* ViewportClient, FViewport* Viewport, const FSceneView* View, FCanvas* Canvas)
+void FDrawAllVisualizersEdMode::DrawLiveVisualizer(const FLiveVisualizer& Live, FVisualizerType& Type, const FSceneView* View, FPrimitiveDrawInterface* PDI,
+                                                   bool bDrawRetained)
 {
-	// FEdMode::DrawHUD(ViewportClient, Viewport, View, Canvas);	// Don't need this.
-
-	if (!bEnabled) return;
+	if (DrawHitProxyInstead(Live.Component, View, PDI)) return;
 
-	if (bNoCache)
+	if (bSplineFastPath && Type.bSplineFastPath && Live.Component != EditedSplineComponent)
 	{
-		const UDrawAllVisualizersSettings* Settings = GetDefault<UDrawAllVisualizersSettings>();
-
-		ForeachActorComponentVisualizer([&](AActor* Actor, const UActorComponent* Component, const TSharedPtr<FComponentVisualizer>& Visualizer)
-		{
-			if (SelectedActors.Contains(Actor)) return;
-			if (Settings->IgnoredVisualizers.Contains(Component->GetClass()->GetFName())) return;
-			Visualizer->DrawVisualizationHUD(Component, Viewport, View, Canvas);
-		});
+		SplineRenderer.Add(static_cast<const USplineComponent*>(Live.Component), View);
 		return;
 	}
 
-	for (const auto& Tuple : CachedVisualizers)
+	if (bDrawRetained && Type.bRetainable)
 	{
-		const FCachedVisualizer& CachedVisualizer = Tuple.Value;
-		const UActorComponent* Component = Tuple.Key.Get();
-		if (Component == nullptr) continue;
-
-		if (CachedVisualizer.IsSelected) continue;
-
-		UWorld* World = Component->GetWorld();
-		if (World == nullptr || World->WorldType == EWorldType::EditorPreview) continue;
+		FRetainedGeometry& Retained = CachedVisualizers.FindOrAddGeometry(Type.Entries[Live.EntryIndex]);
+		if (Retained.NeedsRecording(Live.Component))
+		{
+			Retained.Record(Type.Visualizer.Get(), Live.Component, View);
+		}
 
-		CachedVisualizer.Visualizer->DrawVisualizationHUD(Component, Viewport, View, Canvas);
+		if (!Retained.Geometry.bUnsupported)
+		{
+			Retained.Geometry.Replay(PDI);
+			return;
+		}
 	}
-}
 
-void FDrawAllVisualizersEdMode::OnSelectionChanged(UObject* Obj)
-{
-	bNeedRebuildSelectedActors = true;
+	Type.Visualizer->DrawVisualization(Live.Component, View, PDI);
 }
 
-void FDrawAllVisualizersEdMode::OnPieStartOrEnd(bool bIsSimulating)
+bool FDrawAllVisualizersEdMode::DrawHitProxyInstead(const UActorComponent* Component, const FSceneView* View, FPrimitiveDrawInterface* PDI) const
 {
-	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "OnPieStartOrEnd simulating {0}", bIsSimulating);
-	bNeedRebuildCachedVisualizers = true;
-	bNeedRebuildSelectedActors = true;
+	// Spline being edited keeps its key and tangent hit proxies, so editing unselected splines works in every mode.
+	if (HitProxyMode == EDrawAllVisualizersHitProxyMode::Full || Component == EditedSplineComponent) return false;
+
+	if (HitProxyMode == EDrawAllVisualizersHitProxyMode::Simplified)
+	{
+		DrawSimplifiedHitProxy(Component, PDI);
+		return true;
+	}
+	return !IsNearCursor(Component, View, HitProxyCursor, HitProxyCursorRadius);
 }
 
-void FDrawAllVisualizersEdMode::OnObjectConstructed(UObject* Obj)
+void FDrawAllVisualizersEdMode::DrawEditedSplineHitProxies(const FSceneView* View, FPrimitiveDrawInterface* PDI)
 {
-	if (!bEnabled | bNeedRebuildCachedVisualizers) return;
+	// Splines of selected actors are drawn by the editor.
+	const USplineComponent* EditedSpline = FindEditedSplineComponent();
+	if (EditedSpline == nullptr || SelectedActors.Contains(EditedSpline->GetOwner())) return;
 
-	UActorComponent* Component = Cast<UActorComponent>(Obj);
-	if (Component == nullptr) return;
+	const UWorld* ViewWorld = GetViewWorld(View);
+	if (EditedSpline->GetWorld() != ViewWorld) return;
 
-	UWorld* World = Component->GetWorld();
-	UE_LOG(LogDrawAllVisualizers, VeryVerbose, TEXT("OnObjectConstructed %s world ptr %p"), *Component->GetPathName(), World);
-
-	// Have to choose between storing TWeakObjectPtr or immediately check for component visualizer from the map.
-	// TWeakObjectPtr would allow optimization opportunities later if multiple components are created per frame.
-	// On the other hand 99% of components might not have visualizer so would be creating weak objects for nothing.
-
-	// Some objects have null world for unknown reasons while loading map. So can't check it yet.
-	// Almost everything is also constructed twice :shrug:, few are not and those are ignored if world is checked at this stage.
-
-	// Could have small cache of last used class types that can be checked in semi branchless fashion before going all the way to FindComponentVisualizer.
+	const TSharedPtr<FComponentVisualizer> Visualizer = GUnrealEd->FindComponentVisualizer(EditedSpline->GetClass());
+	if (Visualizer.IsValid()) Visualizer->DrawVisualization(EditedSpline, View, PDI);
+}
 
-	TSharedPtr<FComponentVisualizer> Visualizer = GUnrealEd->FindComponentVisualizer(Component->GetClass());
-	if (!Visualizer.IsValid()) return;
-	if (GetDefault<UDrawAllVisualizersSettings>()->IgnoredVisualizers.Contains(Component->GetClass()->GetFName())) return;
+EDrawAllVisualizersViewportPolicy FDrawAllVisualizersEdMode::FindViewportPolicy(const FViewportClient* ViewportClient)
+{
+	if (ViewportClient == nullptr) return EDrawAllVisualizersViewportPolicy::Enabled;
 
-	UE_LOGFMT(LogDrawAllVisualizers, VeryVerbose, "Add visualizer {0}", Component->GetPathName());
+	// Other viewports, like asset editors, have no key and are always enabled.
+	const FName* ConfigKey = ViewportConfigKeys.Find(ViewportClient);
+	if (ConfigKey == nullptr) ConfigKey = &ViewportConfigKeys.Add(ViewportClient, FindViewportConfigKey(ViewportClient));
+	return ConfigKey->IsNone() ? EDrawAllVisualizersViewportPolicy::Enabled : GetDefault<UDrawAllVisualizersViewportSettings>()->GetPolicy(*ConfigKey);
+}
 
-	// It could be selected, but need to ignore it.
-	// Adding component to selected actor will not be drawn by the built in visualizer drawing system until selection is updated.
-	// Want to be better than that and draw it immediately.
-	CachedVisualizers.Add(Component, {Visualizer, false});
+void FDrawAllVisualizersEdMode::OnLevelViewportClientListChanged()
+{
+	// Layout changes create new clients, which can reuse addresses of the old ones.
+	ViewportConfigKeys.Reset();
 }
 
-void FDrawAllVisualizersEdMode::RebuildCachedVisualizers()
+bool FDrawAllVisualizersEdMode::MouseMove(FEditorViewportClient* ViewportClient, FViewport* Viewport, int32 x, int32 y)
 {
+	// Viewports that are not realtime keep their hit proxies until something is redrawn. Those drawn around another cursor position would miss
+	// the visualizers under this one.
+	if (Viewport == HitProxyViewport && FVector2D::DistSquared(FVector2D(x, y), FVector2D(HitProxyCursor)) > FMath::Square(0.5f * HitProxyCursorRadius))
+	{
+		HitProxyViewport = nullptr;
+		Viewport->InvalidateHitProxy();
+	}
+	return false;
+}
+
+const TArray<FLiveVisualizer>* FDrawAllVisualizersEdMode::FindLiveVisualizers(const FSceneView* View) const
+{
+	const UWorld* ViewWorld = GetViewWorld(View);
+	const int32 WorldIndex = ViewWorld != nullptr ? CachedVisualizers.FindWorldIndex(ViewWorld) : INDEX_NONE;
+	return LiveVisualizersByWorld.IsValidIndex(WorldIndex) ? &LiveVisualizersByWorld[WorldIndex] : nullptr;
+}
+
+void FDrawAllVisualizersEdMode::DrawLiveVisualizers(const TArray<FLiveVisualizer>& LiveVisualizers, const FSceneView* View, FPrimitiveDrawInterface* PDI,
+                                                    bool bDrawRetained)
+{
+	TArray<FVisualizerType>& Types = CachedVisualizers.GetTypes();
+	for (int32 LiveIndex = 0; LiveIndex < LiveVisualizers.Num();)
+	{
+		// Live entries are grouped by type. Timed and traced per group, per entry would cost more than small visualizers draw.
+		const int32 TypeIndex = LiveVisualizers[LiveIndex].TypeIndex;
+		FVisualizerType& Type = Types[TypeIndex];
+		TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL(*Type.TraceName, DrawAllVisualizersChannel);
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		int32 GroupEnd = LiveIndex + 1;
+		while (GroupEnd < LiveVisualizers.Num() && LiveVisualizers[GroupEnd].TypeIndex == TypeIndex) ++GroupEnd;
+
+		// Retained replay is already cheap and hit proxies can't be recorded, those stay on the game thread.
+		// Single chunk would just wait for one worker.
+		const bool bDrawParallel = bParallelDraw && Type.bParallel && !(bDrawRetained && Type.bRetainable) && !(bSplineFastPath && Type.bSplineFastPath)
+			&& !PDI->IsHitTesting()
+			&& GroupEnd - LiveIndex > VisualizersPerParallelChunk;
+
+		if (bDrawParallel)
+		{
+			DrawLiveVisualizersParallel(LiveVisualizers, LiveIndex, GroupEnd, Type, View, PDI);
+			LiveIndex = GroupEnd;
+		}
+
+		for (; LiveIndex < GroupEnd; ++LiveIndex)
+		{
+			const FLiveVisualizer& Live = LiveVisualizers[LiveIndex];
+			if (bCullView && IsCulled(Live.Component, Type.CullParams, View, ViewMinScreenSize))
+			{
+				++NumCulledLastView;
+				continue;
+			}
+
+			++NumDrawnLastView;
+			DrawLiveVisualizer(Live, Type, View, PDI, bDrawRetained);
+		}
+
+		Type.DrawCycles += FPlatformTime::Cycles64() - StartCycles;
+	}
+}
+
+void FDrawAllVisualizersEdMode::DrawLiveVisualizersParallel(const TArray<FLiveVisualizer>& LiveVisualizers, int32 Begin, int32 End, FVisualizerType& Type,
+                                                            const FSceneView* View, FPrimitiveDrawInterface* PDI)
+{
+	// Hit proxies drawn by the workers would be thrown away, clicking needs them from the game thread.
+	check(!PDI->IsHitTesting());
+
+	const int32 NumChunks = FMath::DivideAndRoundUp(End - Begin, VisualizersPerParallelChunk);
+	if (ParallelDrawChunks.Num() < NumChunks) ParallelDrawChunks.SetNum(NumChunks);
+
+	FComponentVisualizer* Visualizer = Type.Visualizer.Get();
+	const FVisualizerCullParams& CullParams = Type.CullParams;
+	const bool bCull = bCullView;
+	const float MinScreenSize = ViewMinScreenSize;
+
+	ParallelFor(NumChunks, [&](int32 ChunkIndex)
+	{
+		FParallelDrawChunk& Chunk = ParallelDrawChunks[ChunkIndex];
+		Chunk.Geometry.Reset();
+		Chunk.NumDrawn = 0;
+		Chunk.NumCulled = 0;
+
+		FRecordingPDI RecordingPDI(View, Chunk.Geometry);
+		const int32 ChunkEnd = FMath::Min(Begin + (ChunkIndex + 1) * VisualizersPerParallelChunk, End);
+		for (int32 LiveIndex = Begin + ChunkIndex * VisualizersPerParallelChunk; LiveIndex < ChunkEnd; ++LiveIndex)
+		{
+			const UActorComponent* Component = LiveVisualizers[LiveIndex].Component;
+			if (bCull && IsCulled(Component, CullParams, View, MinScreenSize))
+			{
+				++Chunk.NumCulled;
+				continue;
+			}
+
+			++Chunk.NumDrawn;
+
+			// Visualizers allocate hit proxies here even though nothing tests them. Those are ref counted objects, not UObjects, that only hold
+			// weak component pointers. Their ids come from the global hit proxy array, which is locked as the render thread frees proxies too.
+			// Garbage collection can't run meanwhile, the game thread waits in ParallelFor. FRecordingPDI::SetHitProxy frees them right away.
+			Visualizer->DrawVisualization(Component, View, &RecordingPDI);
+		}
+	});
+
+	for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ++ChunkIndex)
+	{
+		const FParallelDrawChunk& Chunk = ParallelDrawChunks[ChunkIndex];
+		NumDrawnLastView += Chunk.NumDrawn;
+		NumCulledLastView += Chunk.NumCulled;
+
+		if (!Chunk.Geometry.bUnsupported)
+		{
+			Chunk.Geometry.Replay(PDI);
+			continue;
+		}
+
+		// Drew meshes or sprites. Those can't be recorded, so draw the chunk again directly and keep the type on the game thread from now on.
+		UE_LOGFMT(LogDrawAllVisualizers, Warning, "{0} is in Parallel Visualizers but draws meshes or sprites, drawing it on game thread", Type.ClassName);
+		Type.bParallel = false;
+
+		const int32 ChunkEnd = FMath::Min(Begin + (ChunkIndex + 1) * VisualizersPerParallelChunk, End);
+		for (int32 LiveIndex = Begin + ChunkIndex * VisualizersPerParallelChunk; LiveIndex < ChunkEnd; ++LiveIndex)
+		{
+			const UActorComponent* Component = LiveVisualizers[LiveIndex].Component;
+			if (bCullView && IsCulled(Component, CullParams, View, ViewMinScreenSize)) continue;
+			Visualizer->DrawVisualization(Component, View, PDI);
+		}
+	}
+}
+
+bool FDrawAllVisualizersEdMode::DrawLiveVisualizersWithBudget(const TArray<FLiveVisualizer>& LiveVisualizers, const FSceneView* View,
+                                                              FPrimitiveDrawInterface* PDI, bool bDrawRetained)
+{
+	UpdateAdaptiveDrawBudget();
+
+	TArray<FVisualizerType>& Types = CachedVisualizers.GetTypes();
+	const uint32 Frame = static_cast<uint32>(GFrameCounter);
+	const bool bHitTesting = PDI->IsHitTesting();
+
+	FDrawBudgetViewState& ViewState = DrawBudgetViewStates.FindOrAdd(View->State);
+	ViewState.LastUsedFrame = GFrameCounter;
+	const uint32 RoundStartFrame = ViewState.RoundStartFrame != 0 ? ViewState.RoundStartFrame : Frame;
+	bool bRoundPending = false;
+
+	PrioritizedVisualizers.Reset();
+	for (int32 LiveIndex = 0; LiveIndex < LiveVisualizers.Num(); ++LiveIndex)
+	{
+		const FLiveVisualizer& Live = LiveVisualizers[LiveIndex];
+		const FVisualizerType& Type = Types[Live.TypeIndex];
+		if (bCullView && IsCulled(Live.Component, Type.CullParams, View, ViewMinScreenSize))
+		{
+			++NumCulledLastView;
+			continue;
+		}
+
+		// Added, not multiplied, so entries without bounds or tiny on screen catch up too.
+		float Priority = GetDrawPriority(Live.Component, View, SelectionNeighbourhood);
+		if (const uint32* DeferredSince = ViewState.DeferredSince.Find(Live.Component))
+		{
+			Priority += (Frame - *DeferredSince) * DeferredPriorityPerFrame;
+		}
+		PrioritizedVisualizers.Add({Priority, LiveIndex});
+	}
+
+	PrioritizedVisualizers.Sort([](const FPrioritizedVisualizer& A, const FPrioritizedVisualizer& B) { return A.Priority > B.Priority; });
+
+	// Type scopes would be split into tiny pieces by the priority order, so only cycles are summed per type here.
+	const uint64 BudgetCycles = static_cast<uint64>(AdaptiveDrawBudgetMs / 1000.0 / FPlatformTime::GetSecondsPerCycle64());
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	bool bOverBudget = false;
+
+	for (const FPrioritizedVisualizer& Prioritized : PrioritizedVisualizers)
+	{
+		const FLiveVisualizer& Live = LiveVisualizers[Prioritized.LiveIndex];
+		FVisualizerType& Type = Types[Live.TypeIndex];
+		FCachedVisualizer& Entry = Type.Entries[Live.EntryIndex];
+
+		const uint64 EntryStartCycles = FPlatformTime::Cycles64();
+		bOverBudget = bOverBudget || EntryStartCycles - StartCycles > BudgetCycles;
+		if (bOverBudget)
+		{
+			++NumDeferredLastView;
+
+			// Deferred entries stay clickable through the simplified box, which selects the actor. Hit proxy passes don't age them.
+			if (bHitTesting)
+			{
+				if (Live.Component == EditedSplineComponent) DrawLiveVisualizer(Live, Type, View, PDI, false);
+				else if (!DrawHitProxyInstead(Live.Component, View, PDI)) DrawSimplifiedHitProxy(Live.Component, PDI);
+				continue;
+			}
+
+			const FObjectKey ComponentKey(Live.Component);
+			const uint32* DeferredSince = ViewState.DeferredSince.Find(ComponentKey);
+			const uint32 Since = DeferredSince != nullptr ? *DeferredSince : Frame;
+			NextDeferredSince.Add(ComponentKey, Since);
+			bRoundPending = bRoundPending || Since <= RoundStartFrame;
+
+			// Previous recording is better than nothing even if the component has changed since.
+			const FRetainedGeometry* Retained = bDrawRetained && Type.bRetainable ? CachedVisualizers.FindGeometry(Entry) : nullptr;
+			if (Retained != nullptr && !Retained->Geometry.bUnsupported)
+			{
+				Retained->Geometry.Replay(PDI);
+			}
+			continue;
+		}
+
+		++NumDrawnLastView;
+		DrawLiveVisualizer(Live, Type, View, PDI, bDrawRetained);
+		Type.DrawCycles += FPlatformTime::Cycles64() - EntryStartCycles;
+	}
+
+	if (bHitTesting) return false;
+
+	Swap(ViewState.DeferredSince, NextDeferredSince);
+	NextDeferredSince.Reset();
+	ViewState.RoundStartFrame = bRoundPending ? RoundStartFrame : 0;
+	return bRoundPending;
+}
+
+void FDrawAllVisualizersEdMode::UpdateAdaptiveDrawBudget()
+{
+	if (LastDrawBudgetUpdateFrame == GFrameCounter) return;
+	LastDrawBudgetUpdateFrame = GFrameCounter;
+
+	for (auto It = DrawBudgetViewStates.CreateIterator(); It; ++It)
+	{
+		if (It.Value().LastUsedFrame + DrawBudgetViewStateFrames < GFrameCounter) It.RemoveCurrent();
+	}
+
+	const float BudgetMs = CVarDrawAllVisualizersDrawBudgetMs.GetValueOnGameThread();
+	const float TargetMs = CVarDrawAllVisualizersTargetFrameMs.GetValueOnGameThread();
+	if (TargetMs <= 0.f || AdaptiveDrawBudgetMs <= 0.f)
+	{
+		AdaptiveDrawBudgetMs = BudgetMs;
+		return;
+	}
+
+	// Shrink fast when frames get slow, like while flying the camera, and grow back slowly so it doesn't oscillate.
+	// Never all the way down, visualizers should keep updating even if slowly.
+	const float FrameMs = FApp::GetDeltaTime() * 1000.0;
+	AdaptiveDrawBudgetMs *= FrameMs > TargetMs ? 0.75f : 1.05f;
+	AdaptiveDrawBudgetMs = FMath::Clamp(AdaptiveDrawBudgetMs, BudgetMs * 0.1f, BudgetMs);
+}
+
+void FDrawAllVisualizersEdMode::DrawHUD(FEditorViewportClient* ViewportClient, FViewport* Viewport, const FSceneView* View, FCanvas* Canvas)
+{
+	// FEdMode::DrawHUD(ViewportClient, Viewport, View, Canvas);	// Don't need this.
+
+	SCOPE_CYCLE_COUNTER(STAT_DrawAllVisualizers_DrawHUD);
+
+	const EDrawAllVisualizersViewportPolicy ViewportPolicy = FindViewportPolicy(ViewportClient);
+	if (IsExcludedByPolicy(ViewportPolicy, View) || IsReducedDetailByPolicy(ViewportPolicy, View)) return;
+
+	if (bNoCache)
+	{
+		ScannedVisualizers.Reset();
+		GatherActorComponentVisualizers(ScannedVisualizers, bParallelScan);
+
+		const UWorld* ViewWorld = GetViewWorld(View);
+		int32 NumDrawn = 0;
+		for (const FScannedVisualizer& Scanned : ScannedVisualizers)
+		{
+			const UActorComponent* Component = Scanned.Component;
+			if (Component->GetWorld() != ViewWorld) continue;
+			if (SelectedActors.Contains(Scanned.Actor)) continue;
+			if (!PassesFilter(Scanned.Actor, Component)) continue;
+			if (ComputeHiddenFlags(Component) != ECachedVisualizerFlags::None) continue;
+			if (bCulling && IsCulled(Component, FindNoCacheCullParams(Component->GetClass()), View)) continue;
+			Scanned.Visualizer->DrawVisualizationHUD(Component, Viewport, View, Canvas);
+			++NumDrawn;
+		}
+		Capture.AddHUD(NumDrawn);
+		return;
+	}
+
+	// Normally already prepared by Render this frame.
+	PrepareLiveVisualizers();
+
+	const TArray<FLiveVisualizer>* LiveVisualizersOfWorld = FindLiveVisualizers(View);
+	if (LiveVisualizersOfWorld == nullptr) return;
+	const TArray<FLiveVisualizer>& LiveVisualizers = *LiveVisualizersOfWorld;
+
+	int32 NumDrawn = 0;
+	TArray<FVisualizerType>& Types = CachedVisualizers.GetTypes();
+	for (int32 LiveIndex = 0; LiveIndex < LiveVisualizers.Num();)
+	{
+		const int32 TypeIndex = LiveVisualizers[LiveIndex].TypeIndex;
+		FVisualizerType& Type = Types[TypeIndex];
+		TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL(*Type.TraceName, DrawAllVisualizersChannel);
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		for (; LiveIndex < LiveVisualizers.Num() && LiveVisualizers[LiveIndex].TypeIndex == TypeIndex; ++LiveIndex)
+		{
+			const FLiveVisualizer& Live = LiveVisualizers[LiveIndex];
+			if (bCulling && IsCulled(Live.Component, Type.CullParams, View)) continue;
+
+			Type.Visualizer->DrawVisualizationHUD(Live.Component, Viewport, View, Canvas);
+			++NumDrawn;
+		}
+
+		Type.DrawCycles += FPlatformTime::Cycles64() - StartCycles;
+	}
+	Capture.AddHUD(NumDrawn);
+}
+
+void FDrawAllVisualizersEdMode::StartCapture(int32 NumFrames, const FString& Path)
+{
+	Capture.Start(NumFrames, Path);
+	GEditor->RedrawAllViewports(false);
+}
+
+void FDrawAllVisualizersEdMode::OnSelectionChanged(UObject* Obj)
+{
+	bNeedRebuildSelectedActors = true;
+}
+
+void FDrawAllVisualizersEdMode::OnPieStartOrEnd(bool bIsSimulating)
+{
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "OnPieStartOrEnd simulating {0}", bIsSimulating);
+	ResumeIngestion();
+	bNeedRebuildCachedVisualizers = true;
+	bNeedRebuildSelectedActors = true;
+}
+
+void FDrawAllVisualizersEdMode::OnPrePieTransition(bool bIsSimulating)
+{
+	// Whole PIE world is duplicated or torn down between this and OnPieStartOrEnd().
+	SuspendIngestion();
+}
+
+void FDrawAllVisualizersEdMode::OnCancelPie()
+{
+	ResumeIngestion();
+}
+
+void FDrawAllVisualizersEdMode::OnBlueprintPreCompile(UBlueprint* Blueprint)
+{
+	// Reinstancing replaces every instance of the class and its children. Widgets, anim blueprints and such don't touch the cache.
+	const UClass* ParentClass = Blueprint != nullptr ? Blueprint->ParentClass.Get() : nullptr;
+	if (ParentClass == nullptr || !(ParentClass->IsChildOf<AActor>() || ParentClass->IsChildOf<UActorComponent>())) return;
+	SuspendIngestion();
+}
+
+void FDrawAllVisualizersEdMode::OnSettingsChanged(UObject* Settings, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	// Filter rules and culling settings are resolved into the cache when entries are added.
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "OnSettingsChanged {0}", PropertyChangedEvent.GetPropertyName());
+	CompileFilter();
+	NoCacheCullParams.Reset();
+	bNeedRebuildCachedVisualizers = true;
+}
+
+void FDrawAllVisualizersEdMode::OnObjectPropertyChanged(UObject* Obj, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	// Visualizer edits like moving spline points notify the property they changed.
+	MarkRetainedGeometryDirty(Obj);
+
+	// Details panel edits can add or remove components and change their visibility.
+	QueueActorRescan(Obj);
+}
+
+void FDrawAllVisualizersEdMode::OnPostUndoRedo()
+{
+	// Undo can touch anything. Recording everything again once is cheaper than figuring out what changed.
+	CachedVisualizers.MarkAllGeometryDirty();
+}
+
+void FDrawAllVisualizersEdMode::OnModulesChanged(FName ModuleName, EModuleChangeReason Reason)
+{
+	// Visualizers are registered from module startup. Resolving again also picks up replaced visualizer instances.
+	CachedVisualizers.ResetResolutions();
+	Filter.ResetClasses();
+	NoCacheCullParams.Reset();
+}
+
+void FDrawAllVisualizersEdMode::OnBlueprintCompiled()
+{
+	// Reparenting can change which visualizer a class gets.
+	CachedVisualizers.ResetResolutions();
+	Filter.ResetClasses();
+	NoCacheCullParams.Reset();
+	ResumeIngestion();
+}
+
+void FDrawAllVisualizersEdMode::OnObjectsReinstanced(const TMap<UObject*, UObject*>& OldToNewInstanceMap)
+{
+	CachedVisualizers.ResetResolutions();
+	Filter.ResetClasses();
+	NoCacheCullParams.Reset();
+}
+
+void FDrawAllVisualizersEdMode::OnPostGarbageCollect()
+{
+	// Resolutions are keyed by class pointer, collected class address could be reused by a new class.
+	CachedVisualizers.ResetResolutions();
+	Filter.ResetClasses();
+	NoCacheCullParams.Reset();
+}
+
+void FDrawAllVisualizersEdMode::MarkRetainedGeometryDirty(UObject* Obj)
+{
+	// Can be called from any thread. Checked before queueing, so events cost nothing while retained mode is off.
+	if (!bRetained) return;
+
+	if (!IsInGameThread())
+	{
+		if (Cast<UActorComponent>(Obj) != nullptr || Cast<AActor>(Obj) != nullptr) IncomingDirtyObjects.Enqueue(Obj);
+		return;
+	}
+
+	if (CachedVisualizers.NumGeometries() == 0) return;
+
+	if (UActorComponent* Component = Cast<UActorComponent>(Obj))
+	{
+		CachedVisualizers.MarkGeometryDirty(Component);
+	}
+	else if (const AActor* Actor = Cast<AActor>(Obj))
+	{
+		// Actor level changes can affect what all of its components draw.
+		TInlineComponentArray<UActorComponent*> Components;
+		Actor->GetComponents(Components, false);
+		for (UActorComponent* ActorComponent : Components)
+		{
+			CachedVisualizers.MarkGeometryDirty(ActorComponent);
+		}
+	}
+}
+
+int32 FDrawAllVisualizersEdMode::ResolveVisualizerTypeSlow(UClass* Class)
+{
+	int32 Resolution = EClassResolution::NoVisualizer;
+
+	TSharedPtr<FComponentVisualizer> Visualizer = GUnrealEd->FindComponentVisualizer(Class);
+	if (Visualizer.IsValid())
+	{
+		const UDrawAllVisualizersSettings* Settings = GetDefault<UDrawAllVisualizersSettings>();
+		if (Filter.GetClassDecision(Class) == EFilterDecision::Exclude)
+		{
+			Resolution = EClassResolution::Ignored;
+		}
+		else
+		{
+			Resolution = CachedVisualizers.FindTypeIndex(Class);
+			if (Resolution == INDEX_NONE)
+			{
+				Resolution = CachedVisualizers.AddType(Class, Visualizer, ResolveCullParams(Class, Settings), IsRetainable(Class, Settings),
+				                                           IsParallelDrawable(Class, Settings));
+			}
+			else
+			{
+				// Resolutions were reset but the type is still alive. Visualizer might have been replaced meanwhile.
+				CachedVisualizers.GetTypes()[Resolution].Visualizer = Visualizer;
+			}
+			CachedVisualizers.GetTypes()[Resolution].bSplineFastPath = IsSplineFastPathVisualizer(Class, Visualizer);
+		}
+	}
+
+	UE_LOGFMT(LogDrawAllVisualizers, VeryVerbose, "Resolved {0} to {1}", Class->GetFName(), Resolution);
+	CachedVisualizers.AddResolution(Class, Resolution);
+	return Resolution;
+}
+
+const FVisualizerCullParams& FDrawAllVisualizersEdMode::FindNoCacheCullParams(const UClass* Class)
+{
+	if (const FVisualizerCullParams* CullParams = NoCacheCullParams.Find(Class)) return *CullParams;
+	return NoCacheCullParams.Add(Class, ResolveCullParams(Class, GetDefault<UDrawAllVisualizersSettings>()));
+}
+
+void FDrawAllVisualizersEdMode::AddScannedVisualizer(AActor* Actor, UActorComponent* Component)
+{
+	const int32 TypeIndex = ResolveVisualizerType(Component->GetClass());
+	if (TypeIndex < 0) return;
+
+	// Only classes with actor conditions get this far and are not always included. Tags, folder or label may have changed since added.
+	if (!PassesFilter(Actor, Component))
+	{
+		CachedVisualizers.Remove(Component);
+		return;
+	}
+
+	UE_LOGFMT(LogDrawAllVisualizers, VeryVerbose, "Add visualizer {0} registered {1}", Component->GetPathName(), Component->IsRegistered());
+
+	const ECachedVisualizerFlags SelectedFlags = SelectedActors.Contains(Actor) ? ECachedVisualizerFlags::Selected : ECachedVisualizerFlags::None;
+	CachedVisualizers.Add(TypeIndex, Component, SelectedFlags | ComputeHiddenFlags(Component));
+}
+
+void FDrawAllVisualizersEdMode::CompileFilter()
+{
+	const UDrawAllVisualizersSettings* Settings = GetDefault<UDrawAllVisualizersSettings>();
+	Filter.Compile(Settings->FilterRules, Settings->IgnoredVisualizers);
+	FilterActor = nullptr;
+}
+
+bool FDrawAllVisualizersEdMode::PassesFilter(const AActor* Actor, const UActorComponent* Component)
+{
+	const EFilterDecision Decision = Filter.GetClassDecision(Component->GetClass());
+	if (Decision != EFilterDecision::PerActor) return Decision == EFilterDecision::Include;
+
+	// Components of an actor come in a row. Actor conditions are evaluated once for all of them.
+	if (Actor != FilterActor || FilterActorFrame != GFrameCounter)
+	{
+		FilterActor = Actor;
+		FilterActorFrame = GFrameCounter;
+		FilterActorFlags = Actor != nullptr ? Filter.ComputeActorFlags(Actor) : 0;
+	}
+	return Filter.IsIncluded(Component->GetClass(), FilterActorFlags);
+}
+
+void FDrawAllVisualizersEdMode::RebuildCachedVisualizers()
+{
+	SCOPE_CYCLE_COUNTER(STAT_DrawAllVisualizers_Rebuild);
+
 	bNeedRebuildCachedVisualizers = false;
 	CachedVisualizers.Reset();
-	const UDrawAllVisualizersSettings* Settings = GetDefault<UDrawAllVisualizersSettings>();
 
-	ForeachActorComponentVisualizer([&](AActor* Actor, UActorComponent* Component, const TSharedPtr<FComponentVisualizer>& Visualizer)
+	// Tracking before scanning so changes while a time sliced rebuild is running are not missed.
+	PendingActors.Reset();
+	PendingLevels.Reset();
+	StartTrackingWorldChanges();
+
+	if (CVarDrawAllVisualizersRebuildBudgetMs.GetValueOnGameThread() > 0.f)
+	{
+		RebuildScan.Start();
+		StepRebuildCachedVisualizers();
+		return;
+	}
+
+	CancelRebuildCachedVisualizers();
+
+	// Classes resolve through the cached table here, so FindComponentVisualizer is called once per class, not per component.
+	ScannedComponents.Reset();
+	GatherActorComponents(ScannedComponents, bParallelScan);
+	for (const FScannedComponent& Scanned : ScannedComponents)
+	{
+		AddScannedVisualizer(Scanned.Actor, Scanned.Component);
+	}
+	ScannedComponents.Reset();
+
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "visualizers found {0}", CachedVisualizers.Num());
+}
+
+void FDrawAllVisualizersEdMode::StepRebuildCachedVisualizers()
+{
+	// Render is called for every viewport. Budget is per frame.
+	if (LastRebuildStepFrame == GFrameCounter) return;
+	LastRebuildStepFrame = GFrameCounter;
+
+	SCOPE_CYCLE_COUNTER(STAT_DrawAllVisualizers_Rebuild);
+
+	// Budget set to 0 while running means finish now.
+	const float BudgetMs = CVarDrawAllVisualizersRebuildBudgetMs.GetValueOnGameThread();
+	const double BudgetSeconds = BudgetMs > 0.f ? BudgetMs / 1000.0 : DBL_MAX;
+
+	const bool bFinished = RebuildScan.Step(BudgetSeconds, [this](AActor* Actor, UActorComponent* Component)
+	{
+		AddScannedVisualizer(Actor, Component);
+	});
+
+	const uint64 ProgressMessageKey = reinterpret_cast<uint64>(this) + 1;
+	if (bFinished)
+	{
+		GEngine->RemoveOnScreenDebugMessage(ProgressMessageKey);
+		UE_LOGFMT(LogDrawAllVisualizers, Verbose, "visualizers found {0}", CachedVisualizers.Num());
+		return;
+	}
+
+	GEngine->AddOnScreenDebugMessage(ProgressMessageKey, 1.f, FColor::Yellow,
+		FString::Printf(TEXT("Draw All Visualizers: building cache %.0f%% (%d/%d actors)"),
+			RebuildScan.GetProgress() * 100.f, RebuildScan.GetNumActorsVisited(), RebuildScan.GetNumActorsTotal()));
+}
+
+void FDrawAllVisualizersEdMode::CancelRebuildCachedVisualizers()
+{
+	if (!RebuildScan.IsRunning()) return;
+
+	RebuildScan.Cancel();
+	GEngine->RemoveOnScreenDebugMessage(reinterpret_cast<uint64>(this) + 1);
+}
+
+void FDrawAllVisualizersEdMode::StartTrackingWorldChanges()
+{
+	if (bTrackingWorldChanges) return;
+	bTrackingWorldChanges = true;
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "StartTrackingWorldChanges");
+
+	// Spawned and deleted actors. Broadcast for all worlds while in editor, PIE included.
+	GEngine->OnLevelActorAdded().AddSP(this, &FDrawAllVisualizersEdMode::OnLevelActorAdded);
+	GEngine->OnLevelActorDeleted().AddSP(this, &FDrawAllVisualizersEdMode::OnLevelActorDeleted);
+
+	// Hiding actors temporarily, like with H or the outliner eye. Actors whose components don't render get no other event for it.
+	GEngine->OnActorTemporarilyVisibilityChanged().AddSP(this, &FDrawAllVisualizersEdMode::OnActorTemporarilyVisibilityChanged);
+
+	// Actors loaded and unloaded by World Partition in editor.
+	ULevel::OnLoadedActorAddedToLevelEvent.AddSP(this, &FDrawAllVisualizersEdMode::OnLoadedActorAddedToLevel);
+	ULevel::OnLoadedActorRemovedFromLevelEvent.AddSP(this, &FDrawAllVisualizersEdMode::OnLoadedActorRemovedFromLevel);
+
+	// Streaming levels and World Partition cells in PIE.
+	FWorldDelegates::LevelAddedToWorld.AddSP(this, &FDrawAllVisualizersEdMode::OnLevelAddedToWorld);
+	FWorldDelegates::PreLevelRemovedFromWorld.AddSP(this, &FDrawAllVisualizersEdMode::OnPreLevelRemovedFromWorld);
+	FWorldDelegates::LevelRemovedFromWorld.AddSP(this, &FDrawAllVisualizersEdMode::OnLevelRemovedFromWorld);
+
+	// World buckets go away with their world. New ones are created when their first entry is added.
+	FWorldDelegates::OnWorldCleanup.AddSP(this, &FDrawAllVisualizersEdMode::OnWorldCleanup);
+
+	// Construction scripts running again replace the components. So does Blueprint reinstancing.
+	FCoreUObjectDelegates::OnObjectsReplaced.AddSP(this, &FDrawAllVisualizersEdMode::OnObjectsReplaced);
+
+	// Layer, data layer and level visibility changes.
+	if (ULayersSubsystem* LayersSubsystem = GEditor->GetEditorSubsystem<ULayersSubsystem>())
+	{
+		LayersSubsystem->OnLayersChanged().AddSP(this, &FDrawAllVisualizersEdMode::OnLayersChanged);
+	}
+	if (UDataLayerEditorSubsystem* DataLayerSubsystem = UDataLayerEditorSubsystem::Get())
+	{
+		DataLayerSubsystem->OnDataLayerChanged().AddSP(this, &FDrawAllVisualizersEdMode::OnDataLayerChanged);
+		DataLayerSubsystem->OnActorDataLayersChanged().AddSP(this, &FDrawAllVisualizersEdMode::OnActorDataLayersChanged);
+	}
+	FEditorDelegates::RefreshLevelBrowser.AddSP(this, &FDrawAllVisualizersEdMode::OnRefreshLevelBrowser);
+
+	// Components added and removed in the components panel of the selected actors.
+	if (FLevelEditorModule* LevelEditor = FModuleManager::GetModulePtr<FLevelEditorModule>("LevelEditor"))
+	{
+		LevelEditor->OnComponentsEdited().AddSP(this, &FDrawAllVisualizersEdMode::OnComponentsEdited);
+	}
+}
+
+void FDrawAllVisualizersEdMode::StopTrackingWorldChanges()
+{
+	// Nothing keeps the cache up to date, so there is nothing to verify either.
+	CancelVerifyCache();
+	IncomingActors.Empty();
+	IncomingDirtyObjects.Empty();
+	PendingActors.Empty();
+	PendingLevels.Empty();
+	bNeedRefreshHiddenFlags = false;
+
+	if (!bTrackingWorldChanges) return;
+	bTrackingWorldChanges = false;
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "StopTrackingWorldChanges");
+
+	if (GEngine != nullptr)
+	{
+		GEngine->OnLevelActorAdded().RemoveAll(this);
+		GEngine->OnLevelActorDeleted().RemoveAll(this);
+		GEngine->OnActorTemporarilyVisibilityChanged().RemoveAll(this);
+	}
+	ULevel::OnLoadedActorAddedToLevelEvent.RemoveAll(this);
+	ULevel::OnLoadedActorRemovedFromLevelEvent.RemoveAll(this);
+	FWorldDelegates::LevelAddedToWorld.RemoveAll(this);
+	FWorldDelegates::PreLevelRemovedFromWorld.RemoveAll(this);
+	FWorldDelegates::LevelRemovedFromWorld.RemoveAll(this);
+	FWorldDelegates::OnWorldCleanup.RemoveAll(this);
+	FCoreUObjectDelegates::OnObjectsReplaced.RemoveAll(this);
+
+	if (GEditor != nullptr)
+	{
+		if (ULayersSubsystem* LayersSubsystem = GEditor->GetEditorSubsystem<ULayersSubsystem>())
+		{
+			LayersSubsystem->OnLayersChanged().RemoveAll(this);
+		}
+		if (UDataLayerEditorSubsystem* DataLayerSubsystem = UDataLayerEditorSubsystem::Get())
+		{
+			DataLayerSubsystem->OnDataLayerChanged().RemoveAll(this);
+			DataLayerSubsystem->OnActorDataLayersChanged().RemoveAll(this);
+		}
+	}
+	FEditorDelegates::RefreshLevelBrowser.RemoveAll(this);
+
+	if (FLevelEditorModule* LevelEditor = FModuleManager::GetModulePtr<FLevelEditorModule>("LevelEditor"))
+	{
+		LevelEditor->OnComponentsEdited().RemoveAll(this);
+	}
+}
+
+void FDrawAllVisualizersEdMode::OnLevelActorAdded(AActor* Actor)
+{
+	QueueActorRescan(Actor);
+}
+
+void FDrawAllVisualizersEdMode::OnLevelActorDeleted(AActor* Actor)
+{
+	// Components are still alive here. Removing now instead of leaving stale entries for Render to sweep.
+	RemoveActorVisualizers(Actor);
+}
+
+void FDrawAllVisualizersEdMode::OnActorTemporarilyVisibilityChanged(AActor* Actor)
+{
+	QueueActorRescan(Actor);
+}
+
+void FDrawAllVisualizersEdMode::OnLoadedActorAddedToLevel(AActor& Actor)
+{
+	QueueActorRescan(&Actor);
+}
+
+void FDrawAllVisualizersEdMode::OnLoadedActorRemovedFromLevel(AActor& Actor)
+{
+	RemoveActorVisualizers(&Actor);
+}
+
+void FDrawAllVisualizersEdMode::OnLevelAddedToWorld(ULevel* Level, UWorld* World)
+{
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "OnLevelAddedToWorld {0}", GetNameSafe(Level));
+	PendingLevels.AddUnique(Level);
+}
+
+void FDrawAllVisualizersEdMode::OnPreLevelRemovedFromWorld(ULevel* Level, UWorld* World)
+{
+	// Removal can take several frames. Entries stop drawing now and are removed once it's done. Whole worlds go with cleanup.
+	if (Level == nullptr) return;
+
+	int32 NumChanged = 0;
+	for (FVisualizerType& Type : CachedVisualizers.GetTypes())
 	{
-		if (Settings->IgnoredVisualizers.Contains(Component->GetClass()->GetFName())) return;
-		UE_LOGFMT(LogDrawAllVisualizers, VeryVerbose, "Add visualizer {0} registered {1}", Component->GetPathName(), Component->IsRegistered());
+		for (FCachedVisualizer& Entry : Type.Entries)
+		{
+			const UActorComponent* Component = Entry.Component.Get();
+			if (Component == nullptr || Component->GetComponentLevel() != Level || EnumHasAnyFlags(Entry.Flags, ECachedVisualizerFlags::Unloaded)) continue;
+
+			EnumAddFlags(Entry.Flags, ECachedVisualizerFlags::Unloaded);
+			++NumChanged;
+		}
+	}
+
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "OnPreLevelRemovedFromWorld {0} unloaded {1}", GetNameSafe(Level), NumChanged);
+	if (NumChanged > 0) bNeedPrepareLiveVisualizers = true;
+}
 
-		CachedVisualizers.Add(Component, {Visualizer, false});
+void FDrawAllVisualizersEdMode::OnLevelRemovedFromWorld(ULevel* Level, UWorld* World)
+{
+	// Null level means all levels of the world.
+	const int32 NumRemoved = CachedVisualizers.RemoveAll([Level, World](const FCachedVisualizer&, const UActorComponent* Component)
+	{
+		if (Component == nullptr) return true;
+		return Level != nullptr ? Component->GetComponentLevel() == Level : Component->GetWorld() == World;
 	});
 
-	if (!OnObjectConstructedHandle.IsValid())
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "OnLevelRemovedFromWorld {0} removed {1}", GetNameSafe(Level), NumRemoved);
+}
+
+void FDrawAllVisualizersEdMode::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	const int32 NumRemoved = CachedVisualizers.RemoveWorld(World);
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "OnWorldCleanup {0} removed {1}", GetNameSafe(World), NumRemoved);
+}
+
+void FDrawAllVisualizersEdMode::OnObjectsReplaced(const TMap<UObject*, UObject*>& OldToNewInstanceMap)
+{
+	for (const TPair<UObject*, UObject*>& Pair : OldToNewInstanceMap)
 	{
-		OnObjectConstructedHandle = FCoreUObjectDelegates::OnObjectConstructed.AddSP(
-			this, &FDrawAllVisualizersEdMode::OnObjectConstructed);
+		// Replacement keeps the slot if its class still resolves to the same type, otherwise the rescan adds it again.
+		if (UActorComponent* OldComponent = Cast<UActorComponent>(Pair.Key))
+		{
+			UActorComponent* NewComponent = Cast<UActorComponent>(Pair.Value);
+			if (NewComponent == nullptr || !CachedVisualizers.TakeOver(OldComponent, NewComponent, ResolveVisualizerType(NewComponent->GetClass())))
+			{
+				CachedVisualizers.Remove(OldComponent);
+			}
+		}
+
+		QueueActorRescan(Pair.Value);
 	}
+}
 
-	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "visualizers found {0}", CachedVisualizers.Num());
+void FDrawAllVisualizersEdMode::OnLayersChanged(const ELayersAction::Type Action, const TWeakObjectPtr<ULayer>& ChangedLayer, const FName& ChangedProperty)
+{
+	bNeedRefreshHiddenFlags = true;
+}
+
+void FDrawAllVisualizersEdMode::OnDataLayerChanged(const EDataLayerAction Action, const TWeakObjectPtr<const UDataLayerInstance>& ChangedDataLayer, const FName& ChangedProperty)
+{
+	bNeedRefreshHiddenFlags = true;
+}
+
+void FDrawAllVisualizersEdMode::OnActorDataLayersChanged(const TWeakObjectPtr<AActor>& ChangedActor)
+{
+	QueueActorRescan(ChangedActor.Get());
+}
+
+void FDrawAllVisualizersEdMode::OnComponentsEdited()
+{
+	// Not told which actor, but the components panel only edits selected ones.
+	for (const TWeakObjectPtr<AActor>& Actor : SelectedActors)
+	{
+		QueueActorRescan(Actor.Get());
+	}
+}
+
+void FDrawAllVisualizersEdMode::OnRefreshLevelBrowser()
+{
+	// Broadcast after level visibility is toggled from the Levels panel, among other things.
+	bNeedRefreshHiddenFlags = true;
+}
+
+void FDrawAllVisualizersEdMode::RefreshAllHiddenFlags()
+{
+	int32 NumChanged = 0;
+	for (FVisualizerType& Type : CachedVisualizers.GetTypes())
+	{
+		for (FCachedVisualizer& Entry : Type.Entries)
+		{
+			// Stale entries are swept by the prepare pass.
+			const UActorComponent* Component = Entry.Component.Get();
+			if (Component == nullptr) continue;
+
+			const ECachedVisualizerFlags NewFlags = (Entry.Flags & ~ECachedVisualizerFlags::Hidden) | ComputeHiddenFlags(Component);
+			if (NewFlags == Entry.Flags) continue;
+
+			Entry.Flags = NewFlags;
+			++NumChanged;
+		}
+	}
+
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "RefreshAllHiddenFlags changed {0}", NumChanged);
+	if (NumChanged > 0) bNeedPrepareLiveVisualizers = true;
+	bNeedRefreshHiddenFlags = false;
+}
+
+void FDrawAllVisualizersEdMode::UpdateHiddenFlags(UActorComponent* Component)
+{
+	if (!CachedVisualizers.Contains(Component)) return;
+	if (CachedVisualizers.SetHiddenFlags(Component, ComputeHiddenFlags(Component))) bNeedPrepareLiveVisualizers = true;
+}
+
+void FDrawAllVisualizersEdMode::QueueActorRescan(UObject* Obj)
+{
+	// Can be called from any thread.
+	if (!bTrackingWorldChanges || bIngestionSuspended) return;
+
+	AActor* Actor = Cast<AActor>(Obj);
+	if (Actor == nullptr)
+	{
+		const UActorComponent* Component = Cast<UActorComponent>(Obj);
+		Actor = Component != nullptr ? Component->GetOwner() : nullptr;
+		if (Actor == nullptr) return;
+	}
+
+	IncomingActors.Enqueue(Actor);
+}
+
+void FDrawAllVisualizersEdMode::SuspendIngestion()
+{
+	if (bIngestionSuspended) return;
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "SuspendIngestion");
+	bIngestionSuspended = true;
+	CancelRebuildCachedVisualizers();
+}
+
+void FDrawAllVisualizersEdMode::ResumeIngestion()
+{
+	if (!bIngestionSuspended) return;
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "ResumeIngestion");
+	bIngestionSuspended = false;
+	bNeedRebuildCachedVisualizers = true;
+}
+
+void FDrawAllVisualizersEdMode::RemoveActorVisualizers(const AActor* Actor)
+{
+	if (!bTrackingWorldChanges || Actor == nullptr) return;
+
+	TInlineComponentArray<UActorComponent*> Components;
+	Actor->GetComponents(Components, false);
+	for (UActorComponent* Component : Components)
+	{
+		CachedVisualizers.Remove(Component);
+	}
+}
+
+void FDrawAllVisualizersEdMode::ProcessPendingWorldChanges()
+{
+	if (LastProcessedChangesFrame == GFrameCounter) return;
+	LastProcessedChangesFrame = GFrameCounter;
+
+	// Whatever was queued during a bulk operation is covered by the rebuild that follows it.
+	if (bIngestionSuspended)
+	{
+		IncomingActors.Empty();
+		IncomingDirtyObjects.Empty();
+		PendingActors.Reset();
+		PendingLevels.Reset();
+		return;
+	}
+
+	TWeakObjectPtr<AActor> IncomingActor;
+	while (IncomingActors.Dequeue(IncomingActor))
+	{
+		PendingActors.Add(MoveTemp(IncomingActor));
+	}
+
+	TWeakObjectPtr<UObject> IncomingDirtyObject;
+	while (IncomingDirtyObjects.Dequeue(IncomingDirtyObject))
+	{
+		if (UObject* DirtyObject = IncomingDirtyObject.Get()) MarkRetainedGeometryDirty(DirtyObject);
+	}
+
+	if (PendingActors.Num() == 0 && PendingLevels.Num() == 0 && !bNeedRefreshHiddenFlags) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_DrawAllVisualizers_ProcessWorldChanges);
+
+	if (bNeedRefreshHiddenFlags) RefreshAllHiddenFlags();
+
+	const bool bIsPlaying = GEditor->IsPlayingSessionInEditor();
+	TInlineComponentArray<UActorComponent*> Components;
+
+	for (const TWeakObjectPtr<ULevel>& WeakLevel : PendingLevels)
+	{
+		const ULevel* Level = WeakLevel.Get();
+		if (!IsValid(Level) || !ShouldScanWorld(Level->GetWorld(), bIsPlaying)) continue;
+
+		for (AActor* Actor : Level->Actors)
+		{
+			if (!IsValid(Actor)) continue;
+
+			ForeachComponent(Actor, Components, [this](AActor* Actor, UActorComponent* Component)
+			{
+				AddScannedVisualizer(Actor, Component);
+				UpdateHiddenFlags(Component);
+			});
+		}
+	}
+
+	for (const TWeakObjectPtr<AActor>& WeakActor : PendingActors)
+	{
+		AActor* Actor = WeakActor.Get();
+		if (!IsValid(Actor) || !ShouldScanWorld(Actor->GetWorld(), bIsPlaying)) continue;
+
+		// Components that are gone are either removed already or swept as stale entries.
+		// Additions and visibility changes of the ones that stay matter here.
+		ForeachComponent(Actor, Components, [this](AActor* Actor, UActorComponent* Component)
+		{
+			AddScannedVisualizer(Actor, Component);
+			UpdateHiddenFlags(Component);
+		});
+	}
+
+	UE_LOGFMT(LogDrawAllVisualizers, VeryVerbose, "ProcessPendingWorldChanges levels {0} actors {1}", PendingLevels.Num(), PendingActors.Num());
+
+	PendingActors.Reset();
+	PendingLevels.Reset();
+}
+
+// Verification of entries in the cache snapshot checks time only every this many entries.
+constexpr int32 VerifyEntriesPerTimeCheck = 64;
+
+// Rest of the mismatches of a pass are only counted.
+constexpr int32 MaxLoggedMismatchesPerPass = 20;
+
+void FDrawAllVisualizersEdMode::StepVerifyCache()
+{
+	// Render is called for every viewport. Budget is per frame.
+	if (LastVerifyStepFrame == GFrameCounter) return;
+	LastVerifyStepFrame = GFrameCounter;
+
+	// Cache that is still being built is expected to differ.
+	const float IntervalSeconds = CVarDrawAllVisualizersVerifyIntervalSeconds.GetValueOnGameThread();
+	if (IntervalSeconds <= 0.f || !bTrackingWorldChanges || bNeedRebuildCachedVisualizers || RebuildScan.IsRunning() || bIngestionSuspended)
+	{
+		CancelVerifyCache();
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	if (!VerifyScan.IsRunning() && VerifyEntryIndex == INDEX_NONE)
+	{
+		if (StartTime < NextVerifyTime) return;
+		VerifyCounts = FCacheMismatchCounts();
+		VerifyScan.Start();
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_DrawAllVisualizers_Verify);
+
+	const bool bRepair = CVarDrawAllVisualizersVerifyRepair.GetValueOnGameThread();
+	const double BudgetSeconds = FMath::Max(CVarDrawAllVisualizersVerifyBudgetMs.GetValueOnGameThread(), 0.01f) / 1000.0;
+
+	if (VerifyScan.IsRunning())
+	{
+		const bool bFinished = VerifyScan.Step(BudgetSeconds, [this, bRepair](AActor* Actor, UActorComponent* Component)
+		{
+			VerifyComponent(Actor, Component, bRepair);
+		});
+		if (!bFinished) return;
+
+		// Repairs swap entries around, so the rest of the pass goes through a copy.
+		VerifyEntries.Reset(CachedVisualizers.Num());
+		for (const FVisualizerType& Type : CachedVisualizers.GetTypes())
+		{
+			for (const FCachedVisualizer& Entry : Type.Entries)
+			{
+				VerifyEntries.Add(Entry.Component);
+			}
+		}
+		VerifyEntryIndex = 0;
+	}
+
+	const bool bIsPlaying = GEditor->IsPlayingSessionInEditor();
+	for (; VerifyEntryIndex < VerifyEntries.Num(); ++VerifyEntryIndex)
+	{
+		if (VerifyEntryIndex % VerifyEntriesPerTimeCheck == 0 && FPlatformTime::Seconds() - StartTime > BudgetSeconds) return;
+
+		VerifyCachedEntry(VerifyEntries[VerifyEntryIndex].Get(), bIsPlaying, bRepair);
+	}
+
+	FinishVerifyCache(IntervalSeconds, bRepair);
+}
+
+void FDrawAllVisualizersEdMode::CancelVerifyCache()
+{
+	VerifyScan.Cancel();
+	VerifyEntries.Empty();
+	VerifyEntryIndex = INDEX_NONE;
+}
+
+void FDrawAllVisualizersEdMode::VerifyComponent(AActor* Actor, UActorComponent* Component, bool bRepair)
+{
+	// Cached components that should not be are found from the cache snapshot.
+	const int32 TypeIndex = ResolveVisualizerType(Component->GetClass());
+	if (TypeIndex < 0 || !PassesFilter(Actor, Component)) return;
+
+	const FCachedVisualizerSlot* Slot = CachedVisualizers.FindSlot(Component);
+	if (Slot == nullptr)
+	{
+		ReportCacheMismatch(VerifyCounts.Missing, TEXT("missing"), Component);
+		if (bRepair) AddScannedVisualizer(Actor, Component);
+		return;
+	}
+
+	if (Slot->TypeIndex != TypeIndex)
+	{
+		ReportCacheMismatch(VerifyCounts.WrongType, TEXT("wrong type"), Component);
+		if (bRepair)
+		{
+			CachedVisualizers.Remove(Component);
+			AddScannedVisualizer(Actor, Component);
+		}
+		return;
+	}
+
+	const FCachedVisualizer& Entry = CachedVisualizers.GetTypes()[Slot->TypeIndex].Entries[Slot->EntryIndex];
+	const bool bSelected = SelectedActors.Contains(Actor);
+	const ECachedVisualizerFlags HiddenFlags = ComputeHiddenFlags(Component);
+	const bool bWrongSelection = Entry.IsSelected() != bSelected;
+	const bool bWrongHidden = (Entry.Flags & ECachedVisualizerFlags::Hidden) != HiddenFlags;
+
+	if (bWrongSelection)
+	{
+		ReportCacheMismatch(VerifyCounts.WrongSelection, bSelected ? TEXT("not flagged selected") : TEXT("flagged selected"), Component);
+		if (bRepair && CachedVisualizers.SetActorSelected(Actor, bSelected) > 0) bNeedPrepareLiveVisualizers = true;
+	}
+
+	if (bWrongHidden)
+	{
+		ReportCacheMismatch(VerifyCounts.WrongHidden, TEXT("wrong hidden flags"), Component);
+		if (bRepair && CachedVisualizers.SetHiddenFlags(Component, HiddenFlags)) bNeedPrepareLiveVisualizers = true;
+	}
+}
+
+void FDrawAllVisualizersEdMode::VerifyCachedEntry(UActorComponent* Component, bool bIsPlaying, bool bRepair)
+{
+	// Destroyed components are swept as stale entries when preparing. Ones removed since the snapshot are fine too.
+	if (Component == nullptr || !CachedVisualizers.Contains(Component)) return;
+
+	AActor* Actor = Component->GetOwner();
+	const bool bShouldBeCached = IsValid(Actor) && ShouldScanWorld(Component->GetWorld(), bIsPlaying)
+		&& ResolveVisualizerType(Component->GetClass()) >= 0 && PassesFilter(Actor, Component);
+	if (bShouldBeCached) return;
+
+	ReportCacheMismatch(VerifyCounts.Extra, TEXT("extra"), Component);
+	if (bRepair) CachedVisualizers.Remove(Component);
+}
+
+void FDrawAllVisualizersEdMode::ReportCacheMismatch(int32& Count, const TCHAR* Kind, const UActorComponent* Component)
+{
+	++Count;
+	if (VerifyCounts.Total() > MaxLoggedMismatchesPerPass) return;
+	UE_LOGFMT(LogDrawAllVisualizers, Warning, "Cache verify: {0} {1}", Kind, Component->GetPathName());
+}
+
+void FDrawAllVisualizersEdMode::FinishVerifyCache(float IntervalSeconds, bool bRepair)
+{
+	VerifyEntries.Reset();
+	VerifyEntryIndex = INDEX_NONE;
+	NextVerifyTime = FPlatformTime::Seconds() + IntervalSeconds;
+	VerifyCountsLastPass = VerifyCounts;
+	SET_DWORD_STAT(STAT_DrawAllVisualizers_NumMismatches, VerifyCounts.Total());
+
+	if (VerifyCounts.Total() == 0)
+	{
+		UE_LOGFMT(LogDrawAllVisualizers, Verbose, "Cache verify: {0} entries match", CachedVisualizers.Num());
+		return;
+	}
+
+	const FString Message = FString::Printf(TEXT("Draw All Visualizers: cache verify found %d missing, %d extra, %d wrong type, %d wrong selection, %d wrong hidden%s"),
+		VerifyCounts.Missing, VerifyCounts.Extra, VerifyCounts.WrongType, VerifyCounts.WrongSelection, VerifyCounts.WrongHidden,
+		bRepair ? TEXT(", repaired") : TEXT(""));
+	UE_LOGFMT(LogDrawAllVisualizers, Warning, "{0}", Message);
+
+	// Stays up until the next pass is done.
+	GEngine->AddOnScreenDebugMessage(reinterpret_cast<uint64>(this) + 2, IntervalSeconds + 10.f, FColor::Red, Message);
 }
 
 void FDrawAllVisualizersEdMode::RebuildSelectedActors()
 {
+	SCOPE_CYCLE_COUNTER(STAT_DrawAllVisualizers_RebuildSelectedActors);
+
 	bNeedRebuildSelectedActors = false;
 
-	SelectedActors.Reset();
+	TSet<TWeakObjectPtr<AActor>> NewSelectedActors;
+	NewSelectedActors.Reserve(SelectedActors.Num());
 	for (FSelectionIterator It = GEditor->GetSelectedActorIterator(); It; ++It)
 	{
-		SelectedActors.Add(static_cast<AActor*>(*It));
+		NewSelectedActors.Add(static_cast<AActor*>(*It));
 	}
 
-	int NumVisualizersSelected = 0;
-	for (auto& Element : CachedVisualizers)
+	// Only actors whose selection actually changed touch the cache.
+	int32 NumVisualizersChanged = 0;
+	int32 NumActorsChanged = 0;
+	for (const TWeakObjectPtr<AActor>& Actor : SelectedActors)
+	{
+		if (NewSelectedActors.Contains(Actor)) continue;
+		++NumActorsChanged;
+
+		// Entries of deleted actors are removed or swept anyway.
+		if (const AActor* ActorPtr = Actor.Get())
+		{
+			NumVisualizersChanged += CachedVisualizers.SetActorSelected(ActorPtr, false);
+		}
+	}
+	for (const TWeakObjectPtr<AActor>& Actor : NewSelectedActors)
 	{
-		UActorComponent* Component = Element.Key.Get();
-		if (Component == nullptr)
+		if (SelectedActors.Contains(Actor)) continue;
+		++NumActorsChanged;
+
+		if (const AActor* ActorPtr = Actor.Get())
 		{
-			Element.Value.IsSelected = false;
-			continue;
+			NumVisualizersChanged += CachedVisualizers.SetActorSelected(ActorPtr, true);
 		}
+	}
+
+	SelectedActors = MoveTemp(NewSelectedActors);
 
-		AActor* Outer = Cast<AActor>(Component->GetOuter());
-		Element.Value.IsSelected = SelectedActors.Contains(Outer);
-		NumVisualizersSelected += Element.Value.IsSelected;
+	SelectionNeighbourhood.Init();
+	for (const TWeakObjectPtr<AActor>& Actor : SelectedActors)
+	{
+		if (const AActor* ActorPtr = Actor.Get()) SelectionNeighbourhood += ActorPtr->GetActorLocation();
 	}
+	if (SelectionNeighbourhood.IsValid) SelectionNeighbourhood = SelectionNeighbourhood.ExpandBy(SelectionNeighbourhoodRadius);
+	if (NumVisualizersChanged > 0) bNeedPrepareLiveVisualizers = true;
 
-	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "SelectedActors {0} visualizers affected {1}/{2}",
-	          SelectedActors.Num(), NumVisualizersSelected, CachedVisualizers.Num());
+	UE_LOGFMT(LogDrawAllVisualizers, Verbose, "SelectedActors {0} changed {1} visualizers affected {2}/{3}",
+	          SelectedActors.Num(), NumActorsChanged, NumVisualizersChanged, CachedVisualizers.Num());
 }
 
-void FDrawAllVisualizersEdMode::DrawOnScreenDebugs()
+void FDrawAllVisualizersEdMode::PrepareLiveVisualizers()
 {
-	TMap<FName, int> VisualizerCounts;
+	TArray<FVisualizerType>& Types = CachedVisualizers.GetTypes();
+	if (LastPreparedFrame != GFrameCounter)
+	{
+		for (FVisualizerType& Type : Types)
+		{
+			Type.DrawCyclesLastFrame = Type.DrawCycles;
+			Type.DrawCycles = 0;
+		}
+	}
+
+	// Components are held as raw pointers, so this has to run at least once per frame. Garbage collection happens between frames.
+	if (LastPreparedFrame == GFrameCounter && LastPreparedEntriesVersion == CachedVisualizers.GetEntriesVersion()
+		&& !bNeedPrepareLiveVisualizers) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_DrawAllVisualizers_Prepare);
 
-	for (auto& Tuple : CachedVisualizers)
+	LiveVisualizersByWorld.SetNum(CachedVisualizers.GetMaxWorldIndex());
+	for (TArray<FLiveVisualizer>& LiveVisualizers : LiveVisualizersByWorld)
 	{
-		UActorComponent* Component = Tuple.Key.Get();
-		UWorld* World = Component->GetWorld();
-		if (World == nullptr || World->WorldType == EWorldType::EditorPreview) continue;
+		LiveVisualizers.Reset();
+	}
+	NumLiveVisualizers = 0;
+
+	for (int32 TypeIndex = 0; TypeIndex < Types.Num(); ++TypeIndex)
+	{
+		int32 NumLive = 0;
+
+		// Sweep first as swap removal moves entries around. Backwards so stale entries can be removed while iterating.
+		// Entries are looked up each time, resolving the class of a reconstructed component can add types.
+		for (int32 EntryIndex = Types[TypeIndex].Entries.Num() - 1; EntryIndex >= 0; --EntryIndex)
+		{
+			const TWeakObjectPtr<UActorComponent> Component = Types[TypeIndex].Entries[EntryIndex].Component;
+			if (!Component.IsValid())
+			{
+				// Also happens when modifying the actor or components, construction script reruns replace them.
+				// Like when moving with the transform gizmo or editing values from details panel.
+				// Replacement with the same name takes over the slot, keeping selection and retained geometry buffer.
+				// Anything else created this way is caught by world change tracking.
+				UActorComponent* Reconstructed = CachedVisualizers.FindReconstructed(Component);
+				if (Reconstructed != nullptr && CachedVisualizers.TakeOver(Component, Reconstructed, ResolveVisualizerType(Reconstructed->GetClass())))
+				{
+					CachedVisualizers.SetHiddenFlags(Reconstructed, ComputeHiddenFlags(Reconstructed));
+					continue;
+				}
+				CachedVisualizers.RemoveAtSwap(TypeIndex, EntryIndex);
+			}
+		}
+
+		TArray<FCachedVisualizer>& Entries = Types[TypeIndex].Entries;
+		for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+		{
+			// Selected and hidden entries are both decided before this, one test covers them.
+			const FCachedVisualizer& CachedVisualizer = Entries[EntryIndex];
+			if (!CachedVisualizer.IsDrawn()) continue;
 
-		VisualizerCounts.FindOrAdd(Component->GetClass()->GetFName()) += 1;
+			// Editor does this. This does not.
+			// if (!Component->IsRegistered()) continue;
+
+			// Worlds that can't be drawn were filtered out when the entry was added.
+			LiveVisualizersByWorld[CachedVisualizer.WorldIndex].Add({CachedVisualizer.Component.Get(), TypeIndex, EntryIndex});
+			++NumLive;
+		}
+
+		Types[TypeIndex].NumLive = NumLive;
+		NumLiveVisualizers += NumLive;
 	}
 
-	VisualizerCounts.ValueStableSort([](int v1, int v2) { return v1 > v2; });
+	SET_DWORD_STAT(STAT_DrawAllVisualizers_NumCached, CachedVisualizers.Num());
+	SET_DWORD_STAT(STAT_DrawAllVisualizers_NumLive, NumLiveVisualizers);
+
+	LastPreparedFrame = GFrameCounter;
+	LastPreparedEntriesVersion = CachedVisualizers.GetEntriesVersion();
+	bNeedPrepareLiveVisualizers = false;
+}
+
+void FDrawAllVisualizersEdMode::DrawOnScreenDebugs()
+{
+	// Counts and timings are kept by the types, only few pointers to sort here.
+	TArray<const FVisualizerType*, TInlineAllocator<32>> SortedTypes;
+	for (const FVisualizerType& Type : CachedVisualizers.GetTypes())
+	{
+		if (Type.Entries.Num() > 0) SortedTypes.Add(&Type);
+	}
+	SortedTypes.StableSort([](const FVisualizerType& A, const FVisualizerType& B)
+	{
+		return A.DrawCyclesLastFrame != B.DrawCyclesLastFrame ? A.DrawCyclesLastFrame > B.DrawCyclesLastFrame : A.NumLive > B.NumLive;
+	});
 
 	TStringBuilder<200> Builder;
-	Builder << "Visualized component types:\n";
-	for (auto& Tuple : VisualizerCounts)
+	Builder << "Drawn " << NumDrawnLastView << " culled " << NumCulledLastView << " deferred " << NumDeferredLastView << " (last view)\n";
+	if (CVarDrawAllVisualizersDrawBudgetMs.GetValueOnGameThread() > 0.f)
+	{
+		Builder.Appendf(TEXT("Draw budget %.2f ms (%.2f ms configured)\n"), AdaptiveDrawBudgetMs, CVarDrawAllVisualizersDrawBudgetMs.GetValueOnGameThread());
+	}
+	if (CVarDrawAllVisualizersCoalesce.GetValueOnGameThread())
+	{
+		Builder << "Coalesced lines " << CoalescedCountsLastView.LinesIn << " -> " << CoalescedCountsLastView.LinesOut
+			<< " points " << CoalescedCountsLastView.PointsIn << " -> " << CoalescedCountsLastView.PointsOut << " (last view)\n";
+	}
+	if (bSplineFastPath)
+	{
+		Builder << "Spline fast path " << SplineRenderer.NumLinesLastFlush() << " lines " << SplineRenderer.Num() << " cached splines "
+			<< SplineRenderer.GetAllocatedSize() / 1024 << " KiB (last view)\n";
+	}
+	if (CVarDrawAllVisualizersVerifyIntervalSeconds.GetValueOnGameThread() > 0.f)
+	{
+		Builder << "Verify mismatches " << VerifyCountsLastPass.Total() << (VerifyScan.IsRunning() || VerifyEntryIndex != INDEX_NONE ? " (verifying)" : "")
+			<< " (last pass)\n";
+	}
+	Builder << "Cache " << CachedVisualizers.Num() << " entries " << NumLiveVisualizers << " live " << CachedVisualizers.NumWorlds() << " worlds "
+		<< CachedVisualizers.NumGeometries() << " retained " << CachedVisualizers.GetAllocatedSize() / 1024 << " KiB\n";
+	Builder << "Visualized component types (live/cached, ms last frame):\n";
+	for (const FVisualizerType* Type : SortedTypes)
 	{
-		Builder << "    " << Tuple.Key << " " << Tuple.Value << '\n';
+		Builder.Appendf(TEXT("    %s %d/%d %.3f ms\n"), *Type->TraceName, Type->NumLive, Type->Entries.Num(),
+		                FPlatformTime::ToMilliseconds64(Type->DrawCyclesLastFrame));
 	}
 
 	GEngine->AddOnScreenDebugMessage(reinterpret_cast<uint64>(this), 1, FColor::Red, Builder.ToString());
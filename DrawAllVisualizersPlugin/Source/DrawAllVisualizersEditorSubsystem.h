@@ -30,10 +30,24 @@
 #include "CoreMinimal.h"
 #include "EditorSubsystem.h"
 #include "EdMode.h"
+#include "Containers/Queue.h"
+#include "Modules/ModuleManager.h"
+#include "DataLayer/DataLayerEditorSubsystem.h"
+#include "Layers/LayersSubsystem.h"
+#include "DrawAllVisualizersCache.h"
+#include "DrawAllVisualizersCapture.h"
+#include "DrawAllVisualizersFilter.h"
+#include "DrawAllVisualizersSplineRenderer.h"
+#include "DrawAllVisualizersWorldScan.h"
+#include <atomic>
 #include "DrawAllVisualizersEditorSubsystem.generated.h"
 
 class FComponentVisualizer;
+class FSceneViewStateInterface;
 class FUICommandInfo;
+class UBlueprint;
+class USplineComponent;
+class UDrawAllVisualizersBenchmarkCommandlet;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogDrawAllVisualizers, Log, All)
 
@@ -48,6 +62,74 @@ public:
 protected:
 	virtual void Deinitialize() override;
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+private:
+	void OnEnabledChanged(IConsoleVariable* Variable);
+	void UpdateEdModeActivation();
+	void RegisterViewportMenu();
+
+	FDelegateHandle EnabledChangedHandle;
+};
+
+USTRUCT()
+struct FDrawAllVisualizersCullingSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, meta = (ClampMin = 0, Units = cm, ToolTip = "Visualizers further away than this are not drawn. 0 means no limit"))
+	float MaxDrawDistance = 0.f;
+
+	UPROPERTY(EditAnywhere, meta = (ClampMin = 0, ClampMax = 1, ToolTip = "Visualizers with smaller screen size than this are not drawn. Screen size is bounds diameter relative to the screen"))
+	float MinScreenSize = 0.f;
+
+	UPROPERTY(EditAnywhere, meta = (ToolTip = "Use for visualizers that draw outside of their component bounds, like camera frustums or attenuation shapes"))
+	bool bSkipFrustumCulling = false;
+};
+
+// What is drawn of unselected visualizers when the editor renders hit proxies for clicking.
+UENUM()
+enum class EDrawAllVisualizersHitProxyMode : uint8
+{
+	// Every visualizer with its own hit proxies, as when drawing normally.
+	Full,
+
+	// Nothing. Unselected visualizers can't be clicked.
+	Skip,
+
+	// One box per component that selects the actor.
+	Simplified,
+
+	// Full detail for visualizers within Hit Proxy Cursor Radius of the mouse, nothing for the rest.
+	NearCursor,
+};
+
+UENUM()
+enum class EDrawAllVisualizersFilterAction : uint8
+{
+	Include,
+	Exclude,
+};
+
+// All set conditions must match for the rule to apply.
+USTRUCT()
+struct FDrawAllVisualizersFilterRule
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere)
+	EDrawAllVisualizersFilterAction Action = EDrawAllVisualizersFilterAction::Exclude;
+
+	UPROPERTY(EditAnywhere, meta = (ToolTip = "Component class, like SplineComponent. Also matches subclasses. None matches all classes"))
+	FName ComponentClass;
+
+	UPROPERTY(EditAnywhere, meta = (ToolTip = "Owning actor must have this tag"))
+	FName ActorTag;
+
+	UPROPERTY(EditAnywhere, meta = (ToolTip = "Owning actor must be in this outliner folder or its subfolders, like Roads/Main"))
+	FName Folder;
+
+	UPROPERTY(EditAnywhere, meta = (ToolTip = "Wildcard for owning actor label, like *Spline*"))
+	FString NamePattern;
 };
 
 UCLASS(config = Editor, defaultconfig, meta = (DisplayName = "Draw All Visualizers"))
@@ -68,11 +150,112 @@ public:
 		ConfigRestartRequired = false))
 	bool bNoCache;
 	
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.RebuildBudgetMs", DisplayName = "Rebuild Budget Ms", ClampMin = 0, Units = ms,
+		ToolTip = "Time per frame used to build the cache, already found visualizers are drawn meanwhile. 0 builds it all in one frame",
+		ConfigRestartRequired = false))
+	float RebuildBudgetMs;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.ParallelScan", DisplayName = "Parallel Scan",
+		ToolTip = "Gather components on worker threads when scanning the whole world. Cache rebuild resolves their visualizers afterwards, NoCache looks them up on the workers too",
+		ConfigRestartRequired = false))
+	bool bParallelScan = true;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.DrawBudgetMs", DisplayName = "Draw Budget Ms", ClampMin = 0, Units = ms,
+		ToolTip = "Time per view used to draw visualizers. Most important ones are drawn first and the rest take turns over next frames. 0 draws everything",
+		ConfigRestartRequired = false))
+	float DrawBudgetMs;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.TargetFrameMs", DisplayName = "Target Frame Ms", ClampMin = 0, Units = ms,
+		ToolTip = "Draw budget shrinks while editor frame time is over this and grows back when under. 0 keeps the budget fixed",
+		ConfigRestartRequired = false))
+	float TargetFrameMs = 33.3f;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.VerifyIntervalSeconds", DisplayName = "Verify Interval Seconds", ClampMin = 0, Units = s,
+		ToolTip = "Compare the cache against a fresh scan this often and report missing, extra and wrongly flagged entries. 0 disables",
+		ConfigRestartRequired = false))
+	float VerifyIntervalSeconds;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.VerifyBudgetMs", DisplayName = "Verify Budget Ms", ClampMin = 0.01, Units = ms,
+		ToolTip = "Time per frame used by the cache verification",
+		ConfigRestartRequired = false))
+	float VerifyBudgetMs = 0.5f;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.VerifyRepair", DisplayName = "Verify Repair",
+		ToolTip = "Fix the entries the cache verification finds wrong instead of only reporting them",
+		ConfigRestartRequired = false))
+	bool bVerifyRepair;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.Culling", DisplayName = "Culling",
+		ToolTip = "Skip visualizers that are outside of the view frustum, too far or too small on screen?",
+		ConfigRestartRequired = false))
+	bool bCulling = true;
+
+	UPROPERTY(config, EditAnywhere, meta = (EditCondition = "bCulling"))
+	FDrawAllVisualizersCullingSettings Culling;
+
+	UPROPERTY(config, EditAnywhere, meta = (EditCondition = "bCulling",
+		ToolTip = "Culling overrides by component class. Also applies to subclasses unless they have their own entry"))
+	TMap<FName, FDrawAllVisualizersCullingSettings> ClassCulling;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.Retained", DisplayName = "Retained",
+		ToolTip = "Record lines and points of visualizers once and draw the recording until the component changes?",
+		ConfigRestartRequired = false))
+	bool bRetained;
+
+	UPROPERTY(config, EditAnywhere, meta = (EditCondition = "bRetained",
+		ToolTip = "Always draw these directly in retained mode. Use for visualizers whose output depends on the view. Also applies to subclasses"))
+	TSet<FName> ImmediateModeVisualizers;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.ParallelDraw", DisplayName = "Parallel Draw",
+		ToolTip = "Draw visualizers of Parallel Visualizers classes on worker threads and replay the output on the game thread",
+		ConfigRestartRequired = false))
+	bool bParallelDraw;
+
+	UPROPERTY(config, EditAnywhere, meta = (EditCondition = "bParallelDraw",
+		ToolTip = "Component classes whose visualizers only read the component when drawing and are safe to call from worker threads. Also applies to subclasses"))
+	TSet<FName> ParallelVisualizers;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.Coalesce", DisplayName = "Coalesce",
+		ToolTip = "Gather lines and points of the whole draw pass, merge duplicates and submit them grouped by depth priority, thickness and color",
+		ConfigRestartRequired = false))
+	bool bCoalesce;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.SplineFastPath", DisplayName = "Spline Fast Path",
+		ToolTip = "Draw unselected splines from cached adaptive tessellation in one line batch instead of the stock spline visualizer",
+		ConfigRestartRequired = false))
+	bool bSplineFastPath = true;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ConsoleVariable = "DrawAllVisualizers.HitProxyMode", DisplayName = "Hit Proxy Mode",
+		ToolTip = "What is drawn of unselected visualizers when the editor renders hit proxies for clicking. Spline being edited is always drawn fully",
+		ConfigRestartRequired = false))
+	EDrawAllVisualizersHitProxyMode HitProxyMode;
+
+	UPROPERTY(config, EditAnywhere, meta = (EditCondition = "HitProxyMode == EDrawAllVisualizersHitProxyMode::NearCursor", ClampMin = 1, Units = px,
+		ToolTip = "Distance from the mouse to the screen space bounds of a visualizer within which it gets full hit proxies"))
+	float HitProxyCursorRadius = 64.f;
+
 	UPROPERTY(EditAnywhere)
 	bool bDisplayVisualizerTypeCountsOnScreen;
 
 	UPROPERTY(config, EditAnywhere, meta = (ToolTip = "Don't draw these FComponentVisualizers"))
 	TSet<FName> IgnoredVisualizers;
+
+	UPROPERTY(config, EditAnywhere, meta = (
+		ToolTip = "Include or exclude components by class, actor tag, outliner folder and actor label. Later rules override earlier ones, everything is included by default"))
+	TArray<FDrawAllVisualizersFilterRule> FilterRules;
 	
 	virtual void PostInitProperties() override;
 	virtual FName GetCategoryName() const override;
@@ -82,6 +265,36 @@ public:
 #endif
 };
 
+UENUM()
+enum class EDrawAllVisualizersViewportPolicy : uint8
+{
+	Enabled,
+	Disabled,
+	PerspectiveOnly,
+	OrthographicOnly,
+
+	// Orthographic views skip small visualizers and HUD drawing. Perspective views draw normally.
+	ReducedOrthographic,
+};
+
+// Per user, so everyone can set up their own layout. Keyed by viewport config key, like "FourPanes2x2.Viewport 1".
+UCLASS(config = EditorPerProjectUserSettings)
+class UDrawAllVisualizersViewportSettings : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(config)
+	TMap<FName, EDrawAllVisualizersViewportPolicy> ViewportPolicies;
+
+	EDrawAllVisualizersViewportPolicy GetPolicy(FName ConfigKey) const
+	{
+		const EDrawAllVisualizersViewportPolicy* Policy = ViewportPolicies.Find(ConfigKey);
+		return Policy != nullptr ? *Policy : EDrawAllVisualizersViewportPolicy::Enabled;
+	}
+	void SetPolicy(FName ConfigKey, EDrawAllVisualizersViewportPolicy Policy);
+};
+
 namespace DrawAllVisualizers
 {
 class FDrawAllVisualizersCommands : public TCommands<FDrawAllVisualizersCommands>
@@ -94,12 +307,16 @@ public:
 	TSharedPtr<FUICommandInfo> ToggleDrawAllVisualizersEnabledCommand;
 };
 
-struct FCachedVisualizer
+// Differences between the cache and a fresh scan found by one verification pass.
+struct FCacheMismatchCounts
 {
-	TSharedPtr<FComponentVisualizer> Visualizer;
+	int32 Missing = 0;
+	int32 Extra = 0;
+	int32 WrongType = 0;
+	int32 WrongSelection = 0;
+	int32 WrongHidden = 0;
 
-	// Visualizers for selected actors are skipped. Let default drawing system handle those.
-	bool IsSelected = false;
+	int32 Total() const { return Missing + Extra + WrongType + WrongSelection + WrongHidden; }
 };
 
 class FDrawAllVisualizersEdMode : public FEdMode
@@ -117,30 +334,219 @@ public:
 	virtual bool IsCompatibleWith(FEditorModeID OtherModeID) const override;
 	virtual void Render(const FSceneView* View, FViewport* Viewport, FPrimitiveDrawInterface* PDI) override;
 	virtual void DrawHUD(FEditorViewportClient* ViewportClient, FViewport* Viewport, const FSceneView* View, FCanvas* Canvas) override;
+	virtual bool MouseMove(FEditorViewportClient* ViewportClient, FViewport* Viewport, int32 x, int32 y) override;
+
+	// Records PDI calls of the next NumFrames frames drawn by Render to a file. See DrawAllVisualizers.Capture.
+	void StartCapture(int32 NumFrames, const FString& Path);
 
 protected:
+	// Times the cache rebuild directly and reads cache sizes.
+	friend class ::UDrawAllVisualizersBenchmarkCommandlet;
+
+	// Bound only while the mode is active.
+	void BindDelegates();
+	void UnbindDelegates();
+
 	void OnSelectionChanged(UObject* Obj);
 	void OnPieStartOrEnd(bool bIsSimulating);
-	void OnObjectConstructed(UObject* Obj);
+	void OnPrePieTransition(bool bIsSimulating);
+	void OnCancelPie();
+	void OnBlueprintPreCompile(UBlueprint* Blueprint);
+	void OnSettingsChanged(UObject* Settings, FPropertyChangedEvent& PropertyChangedEvent);
+	void OnObjectPropertyChanged(UObject* Obj, FPropertyChangedEvent& PropertyChangedEvent);
+	void OnPostUndoRedo();
+	void OnModulesChanged(FName ModuleName, EModuleChangeReason Reason);
+	void OnBlueprintCompiled();
+	void OnObjectsReinstanced(const TMap<UObject*, UObject*>& OldToNewInstanceMap);
+	void OnPostGarbageCollect();
+
+	void MarkRetainedGeometryDirty(UObject* Obj);
+
+	// Keep the cache up to date by following changes in worlds that are drawn.
+	void StartTrackingWorldChanges();
+	void StopTrackingWorldChanges();
+	void OnLevelActorAdded(AActor* Actor);
+	void OnLevelActorDeleted(AActor* Actor);
+	void OnActorTemporarilyVisibilityChanged(AActor* Actor);
+	void OnLoadedActorAddedToLevel(AActor& Actor);
+	void OnLoadedActorRemovedFromLevel(AActor& Actor);
+	void OnLevelAddedToWorld(ULevel* Level, UWorld* World);
+	void OnPreLevelRemovedFromWorld(ULevel* Level, UWorld* World);
+	void OnLevelRemovedFromWorld(ULevel* Level, UWorld* World);
+	void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+	void OnObjectsReplaced(const TMap<UObject*, UObject*>& OldToNewInstanceMap);
+	void OnLayersChanged(const ELayersAction::Type Action, const TWeakObjectPtr<ULayer>& ChangedLayer, const FName& ChangedProperty);
+	void OnDataLayerChanged(const EDataLayerAction Action, const TWeakObjectPtr<const UDataLayerInstance>& ChangedDataLayer, const FName& ChangedProperty);
+	void OnActorDataLayersChanged(const TWeakObjectPtr<AActor>& ChangedActor);
+	void OnComponentsEdited();
+	void OnRefreshLevelBrowser();
+	void RefreshAllHiddenFlags();
+	void UpdateHiddenFlags(UActorComponent* Component);
+	void QueueActorRescan(UObject* Obj);
+	void SuspendIngestion();
+	void ResumeIngestion();
+	void RemoveActorVisualizers(const AActor* Actor);
+	void ProcessPendingWorldChanges();
+
+	void StepVerifyCache();
+	void CancelVerifyCache();
+	void VerifyComponent(AActor* Actor, UActorComponent* Component, bool bRepair);
+	void VerifyCachedEntry(UActorComponent* Component, bool bIsPlaying, bool bRepair);
+	void ReportCacheMismatch(int32& Count, const TCHAR* Kind, const UActorComponent* Component);
+	void FinishVerifyCache(float IntervalSeconds, bool bRepair);
 
+	int32 ResolveVisualizerType(UClass* Class)
+	{
+		const int32 Resolution = CachedVisualizers.FindResolution(Class);
+		return Resolution != EClassResolution::Unresolved ? Resolution : ResolveVisualizerTypeSlow(Class);
+	}
+	int32 ResolveVisualizerTypeSlow(UClass* Class);
+	const FVisualizerCullParams& FindNoCacheCullParams(const UClass* Class);
+	EDrawAllVisualizersViewportPolicy FindViewportPolicy(const FViewportClient* ViewportClient);
+	void OnLevelViewportClientListChanged();
+	void AddScannedVisualizer(AActor* Actor, UActorComponent* Component);
+	void CompileFilter();
+	bool PassesFilter(const AActor* Actor, const UActorComponent* Component);
 	void RebuildCachedVisualizers();
+	void StepRebuildCachedVisualizers();
+	void CancelRebuildCachedVisualizers();
 	void RebuildSelectedActors();
+	void PrepareLiveVisualizers();
 
 	void DrawOnScreenDebugs();
 
-	FDelegateHandle OnObjectConstructedHandle;
-	bool bEnabled = false;
+	void DrawLiveVisualizer(const FLiveVisualizer& Live, FVisualizerType& Type, const FSceneView* View, FPrimitiveDrawInterface* PDI, bool bDrawRetained);
+
+	// True when the hit proxy mode replaces the visualizer, with the simplified box or with nothing.
+	bool DrawHitProxyInstead(const UActorComponent* Component, const FSceneView* View, FPrimitiveDrawInterface* PDI) const;
+
+	const TArray<FLiveVisualizer>* FindLiveVisualizers(const FSceneView* View) const;
+	void DrawEditedSplineHitProxies(const FSceneView* View, FPrimitiveDrawInterface* PDI);
+	void DrawLiveVisualizers(const TArray<FLiveVisualizer>& LiveVisualizers, const FSceneView* View, FPrimitiveDrawInterface* PDI, bool bDrawRetained);
+	void DrawLiveVisualizersParallel(const TArray<FLiveVisualizer>& LiveVisualizers, int32 Begin, int32 End, FVisualizerType& Type, const FSceneView* View,
+	                                 FPrimitiveDrawInterface* PDI);
+	// True while entries deferred before the current round started are still waiting, so the view needs another pass.
+	bool DrawLiveVisualizersWithBudget(const TArray<FLiveVisualizer>& LiveVisualizers, const FSceneView* View, FPrimitiveDrawInterface* PDI,
+	                                   bool bDrawRetained);
+	void UpdateAdaptiveDrawBudget();
+
+	// Read by world change events, which can come from loading threads.
+	std::atomic<bool> bTrackingWorldChanges = false;
 	bool bNoCache = false;
+	bool bCulling = true;
+
+	// Also read by retained geometry dirty marks from those threads.
+	std::atomic<bool> bRetained = false;
+	bool bParallelScan = true;
+	bool bParallelDraw = false;
+	bool bSplineFastPath = true;
 	bool bNeedRebuildCachedVisualizers = true;
-	bool bNeedActivateEdMode = false;
 	bool bNeedRebuildSelectedActors = true;
+	bool bNeedPrepareLiveVisualizers = true;
+	bool bNeedRefreshHiddenFlags = false;
+
+	// Culling of the view being drawn by Render. Viewport policy can force it.
+	bool bCullView = true;
+	float ViewMinScreenSize = 0.f;
+
+	// Full unless Render is drawing hit proxies. Near cursor hit proxies are valid only around the cursor they were drawn for,
+	// so moving the mouse away from it invalidates them.
+	EDrawAllVisualizersHitProxyMode HitProxyMode = EDrawAllVisualizersHitProxyMode::Full;
+	FIntPoint HitProxyCursor = FIntPoint(INDEX_NONE);
+	float HitProxyCursorRadius = 0.f;
+	const FViewport* HitProxyViewport = nullptr;
+
+	// There is no event for registering or unregistering component visualizers. Compared every frame to notice it.
+	int32 NumRegisteredVisualizers = 0;
+
+	// 95% of cost comes from DrawVisualization() anyways, but iterating dense per type arrays keeps the rest cheap.
+	FVisualizerCache CachedVisualizers;
+
+	// Filter rules from settings. Class decisions are folded into the resolutions, actor conditions are evaluated once per actor when adding.
+	FVisualizerFilter Filter;
+	const AActor* FilterActor = nullptr;
+	uint64 FilterActorFlags = 0;
+	uint64 FilterActorFrame = 0;
+
+	// Time sliced RebuildCachedVisualizers() in progress. Stepped once per frame from Render.
+	FIncrementalWorldScan RebuildScan;
+	uint64 LastRebuildStepFrame = 0;
+
+	// Time sliced comparison of the cache against the world. World is walked first for missing and wrongly flagged entries,
+	// then a snapshot of the cache for entries that should not be there. Snapshot index is INDEX_NONE while walking the world.
+	FIncrementalWorldScan VerifyScan;
+	TArray<TWeakObjectPtr<UActorComponent>> VerifyEntries;
+	int32 VerifyEntryIndex = INDEX_NONE;
+	FCacheMismatchCounts VerifyCounts;
+	FCacheMismatchCounts VerifyCountsLastPass;
+	double NextVerifyTime = 0.0;
+	uint64 LastVerifyStepFrame = 0;
 
-	// Might not be the ideal container type, but it's good enough, simple to use and convenient. 95% of cost comes from DrawVisualization() anyways.
-	TMap<TWeakObjectPtr<UActorComponent>, FCachedVisualizer> CachedVisualizers;
+	// Reused buffers for full world scans that are not time sliced. Components for the cache rebuild, visualizers for NoCache drawing.
+	TArray<FScannedComponent> ScannedComponents;
+	TArray<FScannedVisualizer> ScannedVisualizers;
+
+	// NoCache drawing has no types to hold culling params. Reset with class resolutions, keyed by class pointer the same way.
+	TMap<const UClass*, FVisualizerCullParams> NoCacheCullParams;
+
+	// Level viewport config key of each viewport client that has drawn, None for other viewports. Policies are looked up by it.
+	TMap<const FViewportClient*, FName> ViewportConfigKeys;
+
+	// Changes gathered from world tracking events. Processed once per frame, so repeated events for the same actor cost nothing extra.
+	// Events can come from loading threads, so actors go through a lock free queue and are deduplicated when drained.
+	TQueue<TWeakObjectPtr<AActor>, EQueueMode::Mpsc> IncomingActors;
+
+	// Retained geometry dirty marks from those threads. Applied on the game thread with the actors, the cache is not thread safe.
+	TQueue<TWeakObjectPtr<UObject>, EQueueMode::Mpsc> IncomingDirtyObjects;
+	TSet<TWeakObjectPtr<AActor>> PendingActors;
+	TArray<TWeakObjectPtr<ULevel>> PendingLevels;
+	uint64 LastProcessedChangesFrame = 0;
+
+	// Bulk operations touch most of the world, often twice. Events are dropped meanwhile and a single rebuild follows.
+	std::atomic<bool> bIngestionSuspended = false;
 
 	// Actor->IsSelectedInEditor() is insanely expensive.
 	// GEditor->GetSelectedActors()->IsSelected(Actor) is one less virtual call and few checks less, but still too much.
 	// Didn't profile GEditor->GetSelectedActorIterator(), but it looks less than ideal. It's used to gather values to this.
-	TInlineComponentArray<AActor*> SelectedActors;
+	// Hashed because marquee selecting thousands of actors made linear searches stall the editor.
+	// Weak so deselected actors that were deleted meanwhile are not touched.
+	TSet<TWeakObjectPtr<AActor>> SelectedActors;
+
+	// Cache resolved and filtered once per frame. Shared by all viewports and by both Render and DrawHUD, so only culling is per view.
+	// Bucketed by cache world index, each view only goes through the world it shows.
+	TArray<TArray<FLiveVisualizer>> LiveVisualizersByWorld;
+	int32 NumLiveVisualizers = 0;
+	uint64 LastPreparedFrame = 0;
+	uint32 LastPreparedEntriesVersion = 0;
+
+	// Counts from the last Render call. For on screen debugs only.
+	int32 NumDrawnLastView = 0;
+	int32 NumCulledLastView = 0;
+	int32 NumDeferredLastView = 0;
+
+	// Draw budget after frame time feedback. Updated once per frame.
+	float AdaptiveDrawBudgetMs = 0.f;
+	uint64 LastDrawBudgetUpdateFrame = 0;
+	TArray<FPrioritizedVisualizer> PrioritizedVisualizers;
+
+	// Keyed by view state, which each editor viewport has its own of. Dropped when the view hasn't drawn for a while.
+	TMap<const FSceneViewStateInterface*, FDrawBudgetViewState> DrawBudgetViewStates;
+	TMap<FObjectKey, uint32> NextDeferredSince;
+
+	// Reused buffer of the coalescing PDI and its counts from the last Render call.
+	FRecordedGeometry CoalescedGeometry;
+	FCoalescedCounts CoalescedCountsLastView;
+
+	// Reused recording buffers for parallel draw, one per chunk.
+	TArray<FParallelDrawChunk> ParallelDrawChunks;
+
+	// Spline being edited through the stock visualizer is drawn by it, even when its actor is not selected.
+	FSplineRenderer SplineRenderer;
+	const USplineComponent* EditedSplineComponent = nullptr;
+
+	// Entries around the selection are drawn first when there is a draw budget.
+	FBox SelectionNeighbourhood = FBox(ForceInit);
+
+	FDrawCapture Capture;
 };
 }
@@ -0,0 +1,154 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DrawAllVisualizersFilter.h"
+#include "DrawAllVisualizersEditorSubsystem.h"
+#include "GameFramework/Actor.h"
+#include "Logging/StructuredLog.h"
+
+namespace DrawAllVisualizers
+{
+void FVisualizerFilter::Compile(const TArray<FDrawAllVisualizersFilterRule>& InRules, const TSet<FName>& IgnoredVisualizers)
+{
+	Rules.Reset();
+	ActorConditions.Reset();
+	ClassFilters.Reset();
+
+	for (const FDrawAllVisualizersFilterRule& InRule : InRules)
+	{
+		FRule& Rule = Rules.AddDefaulted_GetRef();
+		Rule.bInclude = InRule.Action == EDrawAllVisualizersFilterAction::Include;
+		if (!InRule.ComponentClass.IsNone()) Rule.ClassNames.Add(InRule.ComponentClass);
+
+		if (InRule.ActorTag.IsNone() && InRule.Folder.IsNone() && InRule.NamePattern.IsEmpty()) continue;
+
+		if (ActorConditions.Num() == 64)
+		{
+			UE_LOGFMT(LogDrawAllVisualizers, Warning, "Only 64 filter rules can have actor conditions, rest are ignored");
+			Rules.Pop();
+			continue;
+		}
+
+		Rule.ActorMask = uint64(1) << ActorConditions.Num();
+		FActorCondition& Condition = ActorConditions.AddDefaulted_GetRef();
+		Condition.Tag = InRule.ActorTag;
+		Condition.Folder = InRule.Folder;
+		Condition.FolderPrefix = InRule.Folder.ToString() + TEXT("/");
+		Condition.NamePattern = InRule.NamePattern;
+	}
+
+	// Old setting, exact class only. Last so nothing overrides it.
+	if (IgnoredVisualizers.Num() > 0)
+	{
+		FRule& Rule = Rules.AddDefaulted_GetRef();
+		Rule.ClassNames.Append(IgnoredVisualizers.Array());
+		Rule.bExactClass = true;
+	}
+}
+
+uint64 FVisualizerFilter::ComputeActorFlags(const AActor* Actor) const
+{
+	uint64 Flags = 0;
+	for (int32 Index = 0; Index < ActorConditions.Num(); ++Index)
+	{
+		if (ActorConditions[Index].Matches(Actor)) Flags |= uint64(1) << Index;
+	}
+	return Flags;
+}
+
+bool FVisualizerFilter::IsIncluded(const UClass* Class, uint64 ActorFlags)
+{
+	const FClassFilter& ClassFilter = FindOrAddClassFilter(Class);
+	if (ClassFilter.Decision != EFilterDecision::PerActor) return ClassFilter.Decision == EFilterDecision::Include;
+
+	for (const TPair<bool, uint64>& Step : ClassFilter.Steps)
+	{
+		if ((ActorFlags & Step.Value) == Step.Value) return Step.Key;
+	}
+	return true;
+}
+
+FVisualizerFilter::FClassFilter& FVisualizerFilter::FindOrAddClassFilter(const UClass* Class)
+{
+	if (FClassFilter* Found = ClassFilters.Find(Class)) return *Found;
+
+	FClassFilter ClassFilter;
+	for (int32 Index = Rules.Num() - 1; Index >= 0; --Index)
+	{
+		const FRule& Rule = Rules[Index];
+		if (!Rule.MatchesClass(Class)) continue;
+
+		ClassFilter.Steps.Emplace(Rule.bInclude, Rule.ActorMask);
+		if (Rule.ActorMask == 0) break;
+	}
+
+	if (ClassFilter.Steps.Num() == 0)
+	{
+		ClassFilter.Decision = EFilterDecision::Include;
+	}
+	else if (ClassFilter.Steps[0].Value == 0)
+	{
+		ClassFilter.Decision = ClassFilter.Steps[0].Key ? EFilterDecision::Include : EFilterDecision::Exclude;
+		ClassFilter.Steps.Empty();
+	}
+	else
+	{
+		ClassFilter.Decision = EFilterDecision::PerActor;
+	}
+
+	return ClassFilters.Add(Class, MoveTemp(ClassFilter));
+}
+
+bool FVisualizerFilter::FActorCondition::Matches(const AActor* Actor) const
+{
+	if (!Tag.IsNone() && !Actor->Tags.Contains(Tag)) return false;
+
+	if (!Folder.IsNone())
+	{
+		const FName ActorFolder = Actor->GetFolderPath();
+		if (ActorFolder != Folder && !ActorFolder.ToString().StartsWith(FolderPrefix)) return false;
+	}
+
+	if (!NamePattern.IsEmpty() && !Actor->GetActorNameOrLabel().MatchesWildcard(NamePattern)) return false;
+
+	return true;
+}
+
+bool FVisualizerFilter::FRule::MatchesClass(const UClass* Class) const
+{
+	// No class means all classes.
+	if (ClassNames.Num() == 0) return true;
+
+	if (bExactClass) return ClassNames.Contains(Class->GetFName());
+
+	for (const UClass* It = Class; It != nullptr; It = It->GetSuperClass())
+	{
+		if (ClassNames.Contains(It->GetFName())) return true;
+	}
+	return false;
+}
+}
@@ -0,0 +1,99 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+struct FDrawAllVisualizersFilterRule;
+
+namespace DrawAllVisualizers
+{
+enum class EFilterDecision : uint8
+{
+	Include,
+	Exclude,
+
+	// Depends on actor tags, folder or name. Evaluated when the component is added.
+	PerActor,
+};
+
+// Filter rules from settings, compiled so that components of most classes are decided by the class alone.
+// That decision is folded into the class resolution table, so components of excluded classes cost the same as components without a visualizer.
+class FVisualizerFilter
+{
+public:
+	void Compile(const TArray<FDrawAllVisualizersFilterRule>& Rules, const TSet<FName>& IgnoredVisualizers);
+
+	// Must be reset whenever class resolutions are.
+	void ResetClasses() { ClassFilters.Reset(); }
+
+	EFilterDecision GetClassDecision(const UClass* Class) { return FindOrAddClassFilter(Class).Decision; }
+
+	// Bit per rule with actor conditions that the actor passes.
+	uint64 ComputeActorFlags(const AActor* Actor) const;
+
+	bool IsIncluded(const UClass* Class, uint64 ActorFlags);
+
+private:
+	struct FActorCondition
+	{
+		FName Tag;
+		FName Folder;
+		FString FolderPrefix;
+		FString NamePattern;
+
+		bool Matches(const AActor* Actor) const;
+	};
+
+	struct FRule
+	{
+		TArray<FName, TInlineAllocator<1>> ClassNames;
+		bool bExactClass = false;
+		bool bInclude = false;
+
+		// Bit of the actor condition, 0 if the rule applies to all actors.
+		uint64 ActorMask = 0;
+
+		bool MatchesClass(const UClass* Class) const;
+	};
+
+	// Rules that match the class, last rule first. Cut after the first rule without actor conditions as anything before it can't win.
+	struct FClassFilter
+	{
+		EFilterDecision Decision = EFilterDecision::Include;
+		TArray<TPair<bool, uint64>, TInlineAllocator<2>> Steps;
+	};
+
+	FClassFilter& FindOrAddClassFilter(const UClass* Class);
+
+	TArray<FRule> Rules;
+	TArray<FActorCondition> ActorConditions;
+	TMap<const UClass*, FClassFilter> ClassFilters;
+};
+}
@@ -34,6 +34,6 @@ public class DrawAllVisualizersModule : ModuleRules
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 	
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "EditorSubsystem", "DeveloperSettings" });
-		PrivateDependencyModuleNames.AddRange(new string[] { "UnrealEd", "Slate", "SlateCore", "EditorFramework"});
+		PrivateDependencyModuleNames.AddRange(new string[] { "UnrealEd", "Slate", "SlateCore", "EditorFramework", "DataLayerEditor", "ToolMenus", "LevelEditor", "ComponentVisualizers"});
 	}
 }
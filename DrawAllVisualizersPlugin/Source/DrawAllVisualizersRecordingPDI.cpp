@@ -0,0 +1,285 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DrawAllVisualizersRecordingPDI.h"
+#include "ComponentVisualizer.h"
+#include "Algo/Sort.h"
+#include "Algo/Unique.h"
+#include "GameFramework/Actor.h"
+
+namespace DrawAllVisualizers
+{
+void FRecordedGeometry::Reset()
+{
+	Lines.Reset();
+	Points.Reset();
+	bUnsupported = false;
+}
+
+void FRecordedGeometry::Replay(FPrimitiveDrawInterface* PDI) const
+{
+	for (const FLine& Line : Lines)
+	{
+		if (Line.bTranslucent)
+		{
+			PDI->DrawTranslucentLine(Line.Start, Line.End, Line.Color, Line.DepthPriorityGroup, Line.Thickness, Line.DepthBias, Line.bScreenSpace);
+		}
+		else
+		{
+			PDI->DrawLine(Line.Start, Line.End, Line.Color, Line.DepthPriorityGroup, Line.Thickness, Line.DepthBias, Line.bScreenSpace);
+		}
+	}
+
+	for (const FPoint& Point : Points)
+	{
+		PDI->DrawPoint(Point.Position, Point.Color, Point.PointSize, Point.DepthPriorityGroup);
+	}
+}
+
+SIZE_T FRecordedGeometry::GetAllocatedSize() const
+{
+	return Lines.GetAllocatedSize() + Points.GetAllocatedSize();
+}
+
+bool FRetainedGeometry::NeedsRecording(const UActorComponent* Component) const
+{
+	// Transform is compared instead of tracked because there is no cheap global event for it that also covers PIE.
+	return bDirty || !Transform.Equals(GetVisualizerTransform(Component), 0.0);
+}
+
+void FRetainedGeometry::Record(FComponentVisualizer* Visualizer, const UActorComponent* Component, const FSceneView* View)
+{
+	Geometry.Reset();
+	FRecordingPDI RecordingPDI(View, Geometry);
+	Visualizer->DrawVisualization(Component, View, &RecordingPDI);
+
+	if (Geometry.bUnsupported)
+	{
+		// Keep only the flag, visualizer will be drawn directly.
+		Geometry.Lines.Empty();
+		Geometry.Points.Empty();
+	}
+	else
+	{
+		Geometry.Lines.Shrink();
+		Geometry.Points.Shrink();
+	}
+
+	Transform = GetVisualizerTransform(Component);
+	bDirty = false;
+}
+
+FRecordingPDI::FRecordingPDI(const FSceneView* InView, FRecordedGeometry& InGeometry)
+	: FPrimitiveDrawInterface(InView)
+	, Geometry(InGeometry)
+{
+}
+
+void FRecordingPDI::SetHitProxy(HHitProxy* HitProxy)
+{
+	// Visualizers pass newly allocated proxies without keeping a reference. Released here like the real PDI would when done with it.
+	TRefCountPtr<HHitProxy> Release(HitProxy);
+}
+
+void FRecordingPDI::RegisterDynamicResource(FDynamicPrimitiveResource* DynamicResource)
+{
+	Geometry.bUnsupported = true;
+}
+
+void FRecordingPDI::AddReserveLines(uint8 DepthPriorityGroup, int32 NumLines, bool bDepthBiased, bool bThickLines)
+{
+	Geometry.Lines.Reserve(Geometry.Lines.Num() + NumLines);
+}
+
+void FRecordingPDI::DrawSprite(const FVector& Position, float SizeX, float SizeY, const FTexture* Sprite, const FLinearColor& Color, uint8 DepthPriorityGroup,
+                               float U, float UL, float V, float VL, uint8 BlendMode, float OpacityMaskRefVal)
+{
+	Geometry.bUnsupported = true;
+}
+
+void FRecordingPDI::DrawLine(const FVector& Start, const FVector& End, const FLinearColor& Color, uint8 DepthPriorityGroup,
+                             float Thickness, float DepthBias, bool bScreenSpace)
+{
+	Geometry.Lines.Add({Start, End, Color, Thickness, DepthBias, DepthPriorityGroup, bScreenSpace, false});
+}
+
+void FRecordingPDI::DrawTranslucentLine(const FVector& Start, const FVector& End, const FLinearColor& Color, uint8 DepthPriorityGroup,
+                                        float Thickness, float DepthBias, bool bScreenSpace)
+{
+	Geometry.Lines.Add({Start, End, Color, Thickness, DepthBias, DepthPriorityGroup, bScreenSpace, true});
+}
+
+void FRecordingPDI::DrawPoint(const FVector& Position, const FLinearColor& Color, float PointSize, uint8 DepthPriorityGroup)
+{
+	Geometry.Points.Add({Position, Color, PointSize, DepthPriorityGroup});
+}
+
+int32 FRecordingPDI::DrawMesh(const FMeshBatch& Mesh)
+{
+	Geometry.bUnsupported = true;
+	return 0;
+}
+
+FCoalescingPDI::FCoalescingPDI(const FSceneView* InView, FPrimitiveDrawInterface* InTargetPDI, FRecordedGeometry& InGeometry)
+	: FRecordingPDI(InView, InGeometry)
+	, TargetPDI(InTargetPDI)
+{
+	Geometry.Reset();
+}
+
+void FCoalescingPDI::RegisterDynamicResource(FDynamicPrimitiveResource* DynamicResource)
+{
+	TargetPDI->RegisterDynamicResource(DynamicResource);
+}
+
+void FCoalescingPDI::DrawSprite(const FVector& Position, float SizeX, float SizeY, const FTexture* Sprite, const FLinearColor& Color, uint8 DepthPriorityGroup,
+                                float U, float UL, float V, float VL, uint8 BlendMode, float OpacityMaskRefVal)
+{
+	TargetPDI->DrawSprite(Position, SizeX, SizeY, Sprite, Color, DepthPriorityGroup, U, UL, V, VL, BlendMode, OpacityMaskRefVal);
+}
+
+int32 FCoalescingPDI::DrawMesh(const FMeshBatch& Mesh)
+{
+	return TargetPDI->DrawMesh(Mesh);
+}
+
+using FLine = FRecordedGeometry::FLine;
+using FPoint = FRecordedGeometry::FPoint;
+
+bool IsSameLineBatch(const FLine& A, const FLine& B)
+{
+	return A.DepthPriorityGroup == B.DepthPriorityGroup && A.bTranslucent == B.bTranslucent && A.bScreenSpace == B.bScreenSpace
+		&& A.Thickness == B.Thickness && A.DepthBias == B.DepthBias;
+}
+
+bool IsSameLine(const FLine& A, const FLine& B)
+{
+	return IsSameLineBatch(A, B) && A.Color == B.Color && A.Start == B.Start && A.End == B.End;
+}
+
+bool IsLessVector(const FVector& A, const FVector& B)
+{
+	if (A.X != B.X) return A.X < B.X;
+	if (A.Y != B.Y) return A.Y < B.Y;
+	return A.Z < B.Z;
+}
+
+bool IsLessColor(const FLinearColor& A, const FLinearColor& B)
+{
+	if (A.R != B.R) return A.R < B.R;
+	if (A.G != B.G) return A.G < B.G;
+	if (A.B != B.B) return A.B < B.B;
+	return A.A < B.A;
+}
+
+// Batch state first, so equal batches end up next to each other. Then color and end points so duplicates do too.
+bool IsLessLine(const FLine& A, const FLine& B)
+{
+	if (A.DepthPriorityGroup != B.DepthPriorityGroup) return A.DepthPriorityGroup < B.DepthPriorityGroup;
+	if (A.bTranslucent != B.bTranslucent) return B.bTranslucent;
+	if (A.bScreenSpace != B.bScreenSpace) return B.bScreenSpace;
+	if (A.Thickness != B.Thickness) return A.Thickness < B.Thickness;
+	if (A.DepthBias != B.DepthBias) return A.DepthBias < B.DepthBias;
+	if (A.Color != B.Color) return IsLessColor(A.Color, B.Color);
+	if (A.Start != B.Start) return IsLessVector(A.Start, B.Start);
+	return IsLessVector(A.End, B.End);
+}
+
+bool IsLessPoint(const FPoint& A, const FPoint& B)
+{
+	if (A.DepthPriorityGroup != B.DepthPriorityGroup) return A.DepthPriorityGroup < B.DepthPriorityGroup;
+	if (A.PointSize != B.PointSize) return A.PointSize < B.PointSize;
+	if (A.Color != B.Color) return IsLessColor(A.Color, B.Color);
+	return IsLessVector(A.Position, B.Position);
+}
+
+void FCoalescingPDI::Flush(FCoalescedCounts& OutCounts)
+{
+	TArray<FLine>& Lines = Geometry.Lines;
+	TArray<FPoint>& Points = Geometry.Points;
+	OutCounts.LinesIn += Lines.Num();
+	OutCounts.PointsIn += Points.Num();
+
+	// Direction doesn't matter, shared edges drawn from both ends merge too.
+	for (FLine& Line : Lines)
+	{
+		if (IsLessVector(Line.End, Line.Start)) Swap(Line.Start, Line.End);
+	}
+
+	Algo::Sort(Lines, IsLessLine);
+	Lines.SetNum(Algo::Unique(Lines, IsSameLine), false);
+
+	Algo::Sort(Points, IsLessPoint);
+	Points.SetNum(Algo::Unique(Points, [](const FPoint& A, const FPoint& B)
+	{
+		return A.DepthPriorityGroup == B.DepthPriorityGroup && A.PointSize == B.PointSize && A.Color == B.Color && A.Position == B.Position;
+	}), false);
+
+	OutCounts.LinesOut += Lines.Num();
+	OutCounts.PointsOut += Points.Num();
+
+	for (int32 BatchStart = 0; BatchStart < Lines.Num();)
+	{
+		int32 BatchEnd = BatchStart + 1;
+		while (BatchEnd < Lines.Num() && IsSameLineBatch(Lines[BatchStart], Lines[BatchEnd])) ++BatchEnd;
+
+		const FLine& First = Lines[BatchStart];
+		TargetPDI->AddReserveLines(First.DepthPriorityGroup, BatchEnd - BatchStart, First.DepthBias != 0.f, First.Thickness > 0.f);
+		for (int32 LineIndex = BatchStart; LineIndex < BatchEnd; ++LineIndex)
+		{
+			const FLine& Line = Lines[LineIndex];
+			if (Line.bTranslucent)
+			{
+				TargetPDI->DrawTranslucentLine(Line.Start, Line.End, Line.Color, Line.DepthPriorityGroup, Line.Thickness, Line.DepthBias, Line.bScreenSpace);
+			}
+			else
+			{
+				TargetPDI->DrawLine(Line.Start, Line.End, Line.Color, Line.DepthPriorityGroup, Line.Thickness, Line.DepthBias, Line.bScreenSpace);
+			}
+		}
+		BatchStart = BatchEnd;
+	}
+
+	for (const FPoint& Point : Points)
+	{
+		TargetPDI->DrawPoint(Point.Position, Point.Color, Point.PointSize, Point.DepthPriorityGroup);
+	}
+
+	Geometry.Reset();
+}
+
+FTransform GetVisualizerTransform(const UActorComponent* Component)
+{
+	if (const USceneComponent* SceneComponent = Cast<USceneComponent>(Component))
+	{
+		return SceneComponent->GetComponentTransform();
+	}
+
+	const AActor* Owner = Component->GetOwner();
+	return Owner != nullptr ? Owner->GetActorTransform() : FTransform::Identity;
+}
+}
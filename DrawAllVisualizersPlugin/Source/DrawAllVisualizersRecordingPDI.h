@@ -0,0 +1,146 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SceneManagement.h"
+
+class FComponentVisualizer;
+class UActorComponent;
+
+namespace DrawAllVisualizers
+{
+// Output of a visualizer in a form that can be drawn again without calling the visualizer.
+// Only lines and points are supported, those are what almost all visualizers draw.
+struct FRecordedGeometry
+{
+	struct FLine
+	{
+		FVector Start;
+		FVector End;
+		FLinearColor Color;
+		float Thickness;
+		float DepthBias;
+		uint8 DepthPriorityGroup;
+		bool bScreenSpace;
+		bool bTranslucent;
+	};
+
+	struct FPoint
+	{
+		FVector Position;
+		FLinearColor Color;
+		float PointSize;
+		uint8 DepthPriorityGroup;
+	};
+
+	TArray<FLine> Lines;
+	TArray<FPoint> Points;
+
+	// Visualizer drew something that can't be recorded, like meshes or sprites. Geometry is incomplete and must not be replayed.
+	bool bUnsupported = false;
+
+	void Reset();
+	void Replay(FPrimitiveDrawInterface* PDI) const;
+	SIZE_T GetAllocatedSize() const;
+};
+
+// Retained output of single cached component. Recorded again only when marked dirty or the component has moved.
+struct FRetainedGeometry
+{
+	FRecordedGeometry Geometry;
+	FTransform Transform;
+	bool bDirty = true;
+
+	bool NeedsRecording(const UActorComponent* Component) const;
+	void Record(FComponentVisualizer* Visualizer, const UActorComponent* Component, const FSceneView* View);
+};
+
+// Output of one chunk of entries drawn on a worker thread. Replayed in chunk order, so the result is the same as drawing on the game thread.
+struct FParallelDrawChunk
+{
+	FRecordedGeometry Geometry;
+	int32 NumDrawn = 0;
+	int32 NumCulled = 0;
+};
+
+// Records lines and points instead of drawing them. Never hit testing, hit proxies are ignored.
+class FRecordingPDI : public FPrimitiveDrawInterface
+{
+public:
+	FRecordingPDI(const FSceneView* InView, FRecordedGeometry& InGeometry);
+
+	virtual bool IsHitTesting() override { return false; }
+	virtual void SetHitProxy(HHitProxy* HitProxy) override;
+	virtual void RegisterDynamicResource(FDynamicPrimitiveResource* DynamicResource) override;
+	virtual void AddReserveLines(uint8 DepthPriorityGroup, int32 NumLines, bool bDepthBiased = false, bool bThickLines = false) override;
+	virtual void DrawSprite(const FVector& Position, float SizeX, float SizeY, const FTexture* Sprite, const FLinearColor& Color, uint8 DepthPriorityGroup,
+	                        float U, float UL, float V, float VL, uint8 BlendMode = 1, float OpacityMaskRefVal = .5f) override;
+	virtual void DrawLine(const FVector& Start, const FVector& End, const FLinearColor& Color, uint8 DepthPriorityGroup,
+	                      float Thickness = 0.0f, float DepthBias = 0.0f, bool bScreenSpace = false) override;
+	virtual void DrawTranslucentLine(const FVector& Start, const FVector& End, const FLinearColor& Color, uint8 DepthPriorityGroup,
+	                                 float Thickness = 0.0f, float DepthBias = 0.0f, bool bScreenSpace = false) override;
+	virtual void DrawPoint(const FVector& Position, const FLinearColor& Color, float PointSize, uint8 DepthPriorityGroup) override;
+	virtual int32 DrawMesh(const FMeshBatch& Mesh) override;
+
+protected:
+	FRecordedGeometry& Geometry;
+};
+
+// Primitive counts of one coalesced pass, before and after merging.
+struct FCoalescedCounts
+{
+	int32 LinesIn = 0;
+	int32 LinesOut = 0;
+	int32 PointsIn = 0;
+	int32 PointsOut = 0;
+};
+
+// Holds back lines and points of a whole draw pass and submits them in Flush(), duplicates merged and sorted so that lines
+// with the same depth priority, thickness and depth bias go to the target in one reserved run. Everything else is passed straight through.
+// Not for hit testing, hit proxies would get mixed up.
+class FCoalescingPDI : public FRecordingPDI
+{
+public:
+	FCoalescingPDI(const FSceneView* InView, FPrimitiveDrawInterface* InTargetPDI, FRecordedGeometry& InGeometry);
+
+	virtual void RegisterDynamicResource(FDynamicPrimitiveResource* DynamicResource) override;
+	virtual void AddReserveLines(uint8 DepthPriorityGroup, int32 NumLines, bool bDepthBiased = false, bool bThickLines = false) override {}
+	virtual void DrawSprite(const FVector& Position, float SizeX, float SizeY, const FTexture* Sprite, const FLinearColor& Color, uint8 DepthPriorityGroup,
+	                        float U, float UL, float V, float VL, uint8 BlendMode = 1, float OpacityMaskRefVal = .5f) override;
+	virtual int32 DrawMesh(const FMeshBatch& Mesh) override;
+
+	void Flush(FCoalescedCounts& OutCounts);
+
+private:
+	FPrimitiveDrawInterface* TargetPDI;
+};
+
+// Transform that retained geometry of the component depends on. Non scene components follow the owning actor.
+FTransform GetVisualizerTransform(const UActorComponent* Component);
+}
@@ -0,0 +1,199 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DrawAllVisualizersSplineRenderer.h"
+#include "Components/SplineComponent.h"
+#include "SceneManagement.h"
+#include "SceneView.h"
+#include "Settings/LevelEditorViewportSettings.h"
+
+namespace DrawAllVisualizers
+{
+// Error allowed at level 0, in pixels and in world units.
+constexpr double SplineTolerancePixels = 0.5;
+constexpr double SplineBaseToleranceWorld = 0.5;
+
+// Each segment is split at least 2^SplineMinDepth times, so S curves whose middle lands on the chord are still noticed.
+constexpr int32 SplineMinDepth = 2;
+constexpr int32 SplineMaxDepth = 8;
+
+constexpr uint64 SplinePruneIntervalFrames = 600;
+
+// Size of a pixel at the closest point of the bounds.
+double ComputeSplineWorldUnitsPerPixel(const FBoxSphereBounds& Bounds, const FSceneView* View)
+{
+	const FMatrix& Projection = View->ViewMatrices.GetProjectionMatrix();
+	const double ScreenScale = Projection.M[0][0] * View->UnscaledViewRect.Width() * 0.5;
+	if (ScreenScale <= UE_SMALL_NUMBER) return SplineBaseToleranceWorld;
+
+	if (!View->IsPerspectiveProjection()) return 1.0 / ScreenScale;
+
+	const double Distance = FMath::Max(FVector::Dist(View->ViewMatrices.GetViewOrigin(), Bounds.Origin) - Bounds.SphereRadius, 1.0);
+	return Distance / ScreenScale;
+}
+
+void SubdivideSplineSegment(const USplineComponent* Spline, float KeyA, float KeyB, const FVector& A, const FVector& B, double Tolerance, int32 Depth,
+                            TArray<FVector>& OutPoints)
+{
+	const float KeyMid = 0.5f * (KeyA + KeyB);
+	const FVector Mid = Spline->GetLocationAtSplineInputKey(KeyMid, ESplineCoordinateSpace::World);
+
+	if (Depth < SplineMinDepth || (Depth < SplineMaxDepth && FMath::PointDistToSegment(Mid, A, B) > Tolerance))
+	{
+		SubdivideSplineSegment(Spline, KeyA, KeyMid, A, Mid, Tolerance, Depth + 1, OutPoints);
+		SubdivideSplineSegment(Spline, KeyMid, KeyB, Mid, B, Tolerance, Depth + 1, OutPoints);
+		return;
+	}
+
+	OutPoints.Add(B);
+}
+
+void TessellateSpline(const USplineComponent* Spline, double Tolerance, TArray<FVector>& OutPoints)
+{
+	OutPoints.Reset();
+
+	const int32 NumSegments = Spline->GetNumberOfSplineSegments();
+	if (NumSegments == 0) return;
+
+	FVector Start = Spline->GetLocationAtSplineInputKey(0.f, ESplineCoordinateSpace::World);
+	OutPoints.Add(Start);
+	for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+	{
+		const FVector End = Spline->GetLocationAtSplineInputKey(Segment + 1.f, ESplineCoordinateSpace::World);
+		SubdivideSplineSegment(Spline, Segment, Segment + 1.f, Start, End, Tolerance, 0, OutPoints);
+		Start = End;
+	}
+}
+
+void FSplineRenderer::Add(const USplineComponent* Spline, const FSceneView* View)
+{
+#if WITH_EDITORONLY_DATA
+	if (!Spline->bDrawDebug) return;
+#endif
+
+	FCachedSpline& Cached = CachedSplines.FindOrAdd(Spline);
+	Cached.LastUsedFrame = GFrameCounter;
+
+	const FTransform& Transform = Spline->GetComponentTransform();
+	if (Cached.Version != Spline->SplineCurves.Version || !Cached.Transform.Equals(Transform, 0.0) || Cached.KeyPositions.IsEmpty())
+	{
+		Cached.Version = Spline->SplineCurves.Version;
+		Cached.Transform = Transform;
+		for (TArray<FVector>& Level : Cached.Levels)
+		{
+			Level.Reset();
+		}
+
+		Cached.KeyPositions.Reset();
+		for (int32 PointIndex = 0; PointIndex < Spline->GetNumberOfSplinePoints(); ++PointIndex)
+		{
+			Cached.KeyPositions.Add(Spline->GetLocationAtSplinePoint(PointIndex, ESplineCoordinateSpace::World));
+		}
+
+		// Same colors and point size as the stock visualizer uses for splines that are not selected.
+#if WITH_EDITORONLY_DATA
+		const bool bIsSplineEditable = !Spline->bModifiedByConstructionScript;
+		Cached.Color = bIsSplineEditable ? Spline->EditorUnselectedSplineSegmentColor.ToFColor(true) : FColor(255, 0, 255, 255);
+		Cached.PointSize = 10.f + (bIsSplineEditable ? GetDefault<ULevelEditorViewportSettings>()->SelectedSplinePointSizeAdjustment : 0.f);
+#else
+		Cached.Color = FColor::White;
+		Cached.PointSize = 10.f;
+#endif
+	}
+
+	const double Tolerance = ComputeSplineWorldUnitsPerPixel(Spline->Bounds, View) * SplineTolerancePixels;
+	const int32 Level = FMath::Clamp(FMath::FloorToInt32(FMath::Log2(Tolerance / SplineBaseToleranceWorld)), 0, NumLevels - 1);
+
+	TArray<FVector>& Points = Cached.Levels[Level];
+	if (Points.IsEmpty()) TessellateSpline(Spline, SplineBaseToleranceWorld * (1 << Level), Points);
+
+	Queued.Add({Spline, Level});
+	NumQueuedLines += FMath::Max(Points.Num() - 1, 0);
+}
+
+void FSplineRenderer::Flush(FPrimitiveDrawInterface* PDI)
+{
+	NumFlushedLines = NumQueuedLines;
+	if (Queued.IsEmpty()) return;
+
+	PDI->AddReserveLines(SDPG_Foreground, NumQueuedLines);
+	for (const FQueuedSpline& Spline : Queued)
+	{
+		const FCachedSpline& Cached = CachedSplines.FindChecked(Spline.Key);
+		const TArray<FVector>& Points = Cached.Levels[Spline.Level];
+		for (int32 Index = 1; Index < Points.Num(); ++Index)
+		{
+			PDI->DrawLine(Points[Index - 1], Points[Index], Cached.Color, SDPG_Foreground);
+		}
+	}
+
+	for (const FQueuedSpline& Spline : Queued)
+	{
+		const FCachedSpline& Cached = CachedSplines.FindChecked(Spline.Key);
+		for (const FVector& Position : Cached.KeyPositions)
+		{
+			PDI->DrawPoint(Position, Cached.Color, Cached.PointSize, SDPG_Foreground);
+		}
+	}
+
+	Queued.Reset();
+	NumQueuedLines = 0;
+}
+
+void FSplineRenderer::Prune(uint64 Frame)
+{
+	if (Frame < LastPruneFrame + SplinePruneIntervalFrames) return;
+	LastPruneFrame = Frame;
+
+	for (auto It = CachedSplines.CreateIterator(); It; ++It)
+	{
+		if (It->Value.LastUsedFrame + SplinePruneIntervalFrames < Frame) It.RemoveCurrent();
+	}
+}
+
+void FSplineRenderer::Empty()
+{
+	CachedSplines.Empty();
+	Queued.Empty();
+	NumQueuedLines = 0;
+	NumFlushedLines = 0;
+}
+
+SIZE_T FSplineRenderer::GetAllocatedSize() const
+{
+	SIZE_T Size = CachedSplines.GetAllocatedSize() + Queued.GetAllocatedSize();
+	for (const TPair<TObjectKey<USplineComponent>, FCachedSpline>& Pair : CachedSplines)
+	{
+		for (const TArray<FVector>& Level : Pair.Value.Levels)
+		{
+			Size += Level.GetAllocatedSize();
+		}
+		Size += Pair.Value.KeyPositions.GetAllocatedSize();
+	}
+	return Size;
+}
+}
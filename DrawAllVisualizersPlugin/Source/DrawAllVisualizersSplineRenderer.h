@@ -0,0 +1,86 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+#include "UObject/ObjectKey.h"
+
+class FPrimitiveDrawInterface;
+class FSceneView;
+class USplineComponent;
+
+namespace DrawAllVisualizers
+{
+// Draws unselected splines like the stock spline visualizer does, but from cached tessellation and as one line batch per view.
+// Stock visualizer evaluates every segment at fixed steps every time it's drawn.
+class FSplineRenderer
+{
+public:
+	// Tessellates when needed and queues the lines. Nothing is drawn before Flush().
+	void Add(const USplineComponent* Spline, const FSceneView* View);
+	void Flush(FPrimitiveDrawInterface* PDI);
+
+	// Drops cached splines that have not been drawn for a while. Does the work only every few hundred frames.
+	void Prune(uint64 Frame);
+	void Empty();
+
+	int32 Num() const { return CachedSplines.Num(); }
+	int32 NumLinesLastFlush() const { return NumFlushedLines; }
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Level N allows 2^N times the error of level 0. Chosen per view from the size of a pixel at the spline.
+	static constexpr int32 NumLevels = 8;
+
+	struct FCachedSpline
+	{
+		FTransform Transform;
+		uint32 Version = 0;
+		uint64 LastUsedFrame = 0;
+
+		// World space polylines, tessellated on first use of each level.
+		TStaticArray<TArray<FVector>, NumLevels> Levels;
+		TArray<FVector> KeyPositions;
+		FColor Color;
+		float PointSize = 0.f;
+	};
+
+	struct FQueuedSpline
+	{
+		TObjectKey<USplineComponent> Key;
+		int32 Level;
+	};
+
+	TMap<TObjectKey<USplineComponent>, FCachedSpline> CachedSplines;
+	TArray<FQueuedSpline> Queued;
+	int32 NumQueuedLines = 0;
+	int32 NumFlushedLines = 0;
+	uint64 LastPruneFrame = 0;
+};
+}
@@ -0,0 +1,122 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DrawAllVisualizersWorldScan.h"
+
+namespace DrawAllVisualizers
+{
+void GatherScannedActors(TArray<AActor*>& OutActors)
+{
+	const bool bIsPlaying = GEditor->IsPlayingSessionInEditor();
+	for (const FWorldContext& WorldContext : GEditor->GetWorldContexts())
+	{
+		const UWorld* World = WorldContext.World();
+		if (!ShouldScanWorld(World, bIsPlaying)) continue;
+
+		for (const ULevel* Level : World->GetLevels())
+		{
+			if (!IsValid(Level)) continue;
+
+			OutActors.Reserve(OutActors.Num() + Level->Actors.Num());
+			for (AActor* Actor : Level->Actors)
+			{
+				if (!IsValid(Actor)) continue;
+
+				OutActors.Add(Actor);
+			}
+		}
+	}
+}
+
+void GatherActorComponentVisualizers(TArray<FScannedVisualizer>& OutVisualizers, bool bParallel)
+{
+	if (!bParallel)
+	{
+		ForeachActorComponentVisualizer([&](AActor* Actor, UActorComponent* Component, const TSharedPtr<FComponentVisualizer>& Visualizer)
+		{
+			OutVisualizers.Add({Actor, Component, Visualizer.Get()});
+		});
+		return;
+	}
+
+	ParallelGatherActorComponents(OutVisualizers, [](AActor* Actor, UActorComponent* Component, TArray<FScannedVisualizer>& Out)
+	{
+		const TSharedPtr<FComponentVisualizer> Visualizer = GUnrealEd->FindComponentVisualizer(Component->GetClass());
+		if (!Visualizer.IsValid()) return;
+
+		Out.Add({Actor, Component, Visualizer.Get()});
+	});
+}
+
+void GatherActorComponents(TArray<FScannedComponent>& OutComponents, bool bParallel)
+{
+	if (!bParallel)
+	{
+		ForeachActorComponent([&](AActor* Actor, UActorComponent* Component)
+		{
+			OutComponents.Add({Actor, Component});
+		});
+		return;
+	}
+
+	ParallelGatherActorComponents(OutComponents, [](AActor* Actor, UActorComponent* Component, TArray<FScannedComponent>& Out)
+	{
+		Out.Add({Actor, Component});
+	});
+}
+
+void FIncrementalWorldScan::Start()
+{
+	Levels.Reset();
+	LevelIndex = 0;
+	ActorIndex = 0;
+	NumActorsTotal = 0;
+	NumActorsVisited = 0;
+	bRunning = true;
+
+	const bool bIsPlaying = GEditor->IsPlayingSessionInEditor();
+	for (const FWorldContext& WorldContext : GEditor->GetWorldContexts())
+	{
+		const UWorld* World = WorldContext.World();
+		if (!ShouldScanWorld(World, bIsPlaying)) continue;
+
+		for (ULevel* Level : World->GetLevels())
+		{
+			if (!IsValid(Level)) continue;
+
+			Levels.Add(Level);
+			NumActorsTotal += Level->Actors.Num();
+		}
+	}
+}
+
+void FIncrementalWorldScan::Cancel()
+{
+	Levels.Reset();
+	bRunning = false;
+}
+}
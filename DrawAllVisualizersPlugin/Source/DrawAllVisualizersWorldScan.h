@@ -0,0 +1,242 @@
+// Copyright (c) Zyni https://github.com/ZyntaxError
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "Editor.h"
+#include "Editor/UnrealEdEngine.h"
+#include "Engine/Level.h"
+#include "UnrealEdGlobals.h"
+
+namespace DrawAllVisualizers
+{
+// Worlds whose components are visualized. During PIE only the game worlds.
+inline bool ShouldScanWorld(const UWorld* World, bool bIsPlaying)
+{
+	if (World == nullptr || World->WorldType == EWorldType::EditorPreview) return false;
+
+	if (bIsPlaying)
+	{
+		if (World->WorldType != EWorldType::Game & World->WorldType != EWorldType::PIE) return false;
+	}
+	return true;
+}
+
+template <typename Func>
+void ForeachComponent(AActor* Actor, TInlineComponentArray<UActorComponent*>& Components, Func F)
+{
+	Components.Reset();
+	Actor->GetComponents(Components, false);
+
+	for (auto Component : Components)
+	{
+		// Editor does this. This does not.
+		// if (!Comp->IsRegistered()) continue;
+
+		F(Actor, Component);
+	}
+}
+
+template <typename Func>
+void ForeachActorComponent(Func F)
+{
+	// Could perhaps just use TObjectIterator<UActorComponent>, but this deeper level route is better for learning.
+
+	bool IsPlaying = GEditor->IsPlayingSessionInEditor();
+	TInlineComponentArray<UActorComponent*> Components;
+
+	const auto& Worlds = GEditor->GetWorldContexts();
+	for (const auto& WorldContext : Worlds)
+	{
+		const UWorld* World = WorldContext.World();
+		if (!ShouldScanWorld(World, IsPlaying)) continue;
+
+		for (const ULevel* Level : World->GetLevels())
+		{
+			if (!IsValid(Level)) continue;
+
+			for (auto Actor : Level->Actors)
+			{
+				if (!IsValid(Actor)) continue;
+
+				ForeachComponent(Actor.Get(), Components, F);
+			}
+		}
+	}
+}
+
+template <typename Func>
+void ForeachActorComponentVisualizer(Func F)
+{
+	ForeachActorComponent([&F](AActor* Actor, UActorComponent* Component)
+	{
+		TSharedPtr<FComponentVisualizer> Visualizer = GUnrealEd->FindComponentVisualizer(Component->GetClass());
+		if (!Visualizer.IsValid()) return;
+
+		F(Actor, Component, Visualizer);
+	});
+}
+
+// Actors of all scanned worlds in the same order ForeachActorComponent visits them.
+void GatherScannedActors(TArray<AActor*>& OutActors);
+
+// Actors per ParallelFor task. Most actors have only few components, so smaller chunks are mostly task overhead.
+constexpr int32 ActorsPerParallelChunk = 128;
+
+// Parallel version of ForeachActorComponent. Actors are gathered on the game thread and split into chunks.
+// Gather runs on worker threads and appends to per chunk buffers, which are merged in actor order.
+// Game thread waits for the workers, so Gather can read game thread state but must not write anything shared.
+template <typename ElementType, typename Func>
+void ParallelGatherActorComponents(TArray<ElementType>& OutResults, Func Gather)
+{
+	TArray<AActor*> Actors;
+	GatherScannedActors(Actors);
+
+	const int32 NumChunks = FMath::DivideAndRoundUp(Actors.Num(), ActorsPerParallelChunk);
+	TArray<TArray<ElementType>> ChunkResults;
+	ChunkResults.SetNum(NumChunks);
+
+	ParallelFor(NumChunks, [&](int32 ChunkIndex)
+	{
+		TInlineComponentArray<UActorComponent*> Components;
+		TArray<ElementType>& ChunkResult = ChunkResults[ChunkIndex];
+
+		const int32 End = FMath::Min((ChunkIndex + 1) * ActorsPerParallelChunk, Actors.Num());
+		for (int32 ActorIndex = ChunkIndex * ActorsPerParallelChunk; ActorIndex < End; ++ActorIndex)
+		{
+			ForeachComponent(Actors[ActorIndex], Components, [&](AActor* Actor, UActorComponent* Component)
+			{
+				Gather(Actor, Component, ChunkResult);
+			});
+		}
+	}, NumChunks < 2 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	int32 NumResults = OutResults.Num();
+	for (const TArray<ElementType>& ChunkResult : ChunkResults)
+	{
+		NumResults += ChunkResult.Num();
+	}
+
+	OutResults.Reserve(NumResults);
+	for (TArray<ElementType>& ChunkResult : ChunkResults)
+	{
+		OutResults.Append(MoveTemp(ChunkResult));
+	}
+}
+
+struct FScannedVisualizer
+{
+	AActor* Actor = nullptr;
+	UActorComponent* Component = nullptr;
+
+	// Owned by GUnrealEd. Registered visualizers are only removed on the game thread.
+	FComponentVisualizer* Visualizer = nullptr;
+};
+
+// Components that have a visualizer, looked up with FindComponentVisualizer for every component. For NoCache drawing, which is
+// the reference path and doesn't trust the cached class resolutions. With bParallel lookups are done on worker threads,
+// FindComponentVisualizer only reads the map of registered visualizers.
+void GatherActorComponentVisualizers(TArray<FScannedVisualizer>& OutVisualizers, bool bParallel);
+
+struct FScannedComponent
+{
+	AActor* Actor = nullptr;
+	UActorComponent* Component = nullptr;
+};
+
+// All components, for the cache rebuild. Classes are resolved afterwards on the game thread through the cached table,
+// one lookup per component, so with bParallel only the actor walk and GetComponents run on worker threads.
+void GatherActorComponents(TArray<FScannedComponent>& OutComponents, bool bParallel);
+
+// Same walk as ForeachActorComponent, but can be split over multiple frames.
+// Levels are gathered when started and the cursor is an index to actors of the current level.
+// Actors added while running can be missed and removed ones can shift others past the cursor,
+// so anything that needs to be exact must also track changes on its own.
+class FIncrementalWorldScan
+{
+public:
+	void Start();
+	void Cancel();
+
+	bool IsRunning() const { return bRunning; }
+	float GetProgress() const { return NumActorsTotal > 0 ? static_cast<float>(NumActorsVisited) / NumActorsTotal : 1.f; }
+	int32 GetNumActorsVisited() const { return NumActorsVisited; }
+	int32 GetNumActorsTotal() const { return NumActorsTotal; }
+
+	// Returns true when the whole scan is finished.
+	template <typename Func>
+	bool Step(double TimeBudgetSeconds, Func F);
+
+private:
+	// Time is checked only every this many actors, it's not free either.
+	static constexpr int32 ActorsPerTimeCheck = 32;
+
+	TArray<TWeakObjectPtr<ULevel>> Levels;
+	TInlineComponentArray<UActorComponent*> Components;
+	int32 LevelIndex = 0;
+	int32 ActorIndex = 0;
+	int32 NumActorsTotal = 0;
+	int32 NumActorsVisited = 0;
+	bool bRunning = false;
+};
+
+template <typename Func>
+bool FIncrementalWorldScan::Step(double TimeBudgetSeconds, Func F)
+{
+	if (!bRunning) return true;
+
+	const double EndTime = FPlatformTime::Seconds() + TimeBudgetSeconds;
+	int32 ActorsUntilTimeCheck = ActorsPerTimeCheck;
+
+	for (; LevelIndex < Levels.Num(); ++LevelIndex, ActorIndex = 0)
+	{
+		const ULevel* Level = Levels[LevelIndex].Get();
+		if (!IsValid(Level)) continue;
+
+		for (; ActorIndex < Level->Actors.Num(); ++ActorIndex)
+		{
+			if (--ActorsUntilTimeCheck <= 0)
+			{
+				if (FPlatformTime::Seconds() > EndTime) return false;
+				ActorsUntilTimeCheck = ActorsPerTimeCheck;
+			}
+
+			++NumActorsVisited;
+			AActor* Actor = Level->Actors[ActorIndex];
+			if (!IsValid(Actor)) continue;
+
+			ForeachComponent(Actor, Components, F);
+		}
+	}
+
+	bRunning = false;
+	NumActorsVisited = NumActorsTotal;
+	return true;
+}
+}